@@ -26,6 +26,7 @@ public BIPlugin(TargetInfo Target)
 			"GraphEditor",
 			"BlueprintGraph",
 			"Kismet",
+			"AssetRegistry",
 		});
 	}
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "BIPluginIndexCommandlet.generated.h"
+
+/** Builds the suggestion database from every blueprint in the asset registry, without opening them in the editor.
+ * Blueprints are loaded in batches and garbage collected once parsed, so memory stays bounded on large projects.
+ * The pin types of the parsed nodes are written to a .nodeinfo file next to the output.
+ * Usage: UE4Editor-Cmd.exe <Project> -run=BIPluginIndex [-BatchSize=<Blueprints>] [-Output=<File>] */
+UCLASS()
+class UBIPluginIndexCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	virtual int32 Main(const FString& a_Params) override;
+};
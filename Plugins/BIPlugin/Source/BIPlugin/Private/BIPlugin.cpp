@@ -6,14 +6,27 @@
 #include "SuggestionDatabaseBase.h"
 #include "SuggestionDatabasePath.h"
 #include "GraphNodeInformationDatabase.h"
+#include "SuggestionDatabaseBenchmark.h"
+#include "SuggestionDatabaseRebuilder.h"
+#include "SuggestionDatabaseSaver.h"
+#include "SuggestionDatabaseReingester.h"
+#include "SuggestionDatabaseSnapshot.h"
 
 namespace
 {
 	const TCHAR* PLUGIN_DATABASE_PATH = TEXT("BIPluginData.bin");
+	const TCHAR* PLUGIN_JOURNAL_PATH = TEXT("BIPluginData.wal");
+	const TCHAR* PLUGIN_NODE_INFORMATION_PATH = TEXT("BIPluginData.nodeinfo");
 }
 
 void BIPluginImpl::StartupModule()
 {
+	//Commandlets such as BIPluginIndex build their own database and must not have it overwritten at shutdown.
+	if (IsRunningCommandlet())
+	{
+		return;
+	}
+
 	UE_LOG(BILog, Warning, TEXT("BIPlugin Startup"));
 
 	m_NodeInformationDatabase = new GraphNodeInformationDatabase();
@@ -23,13 +36,20 @@ void BIPluginImpl::StartupModule()
 	FBlueprintSuggestionProviderManager::Get().RegisterBlueprintSuggestionProvider(m_SuggestionProvider);
 
 	m_SuggestionDatabase->SetGraphNodeDatabase(m_NodeInformationDatabase);
+	m_DatabaseRebuilder = new SuggestionDatabaseRebuilder(*m_SuggestionDatabase,
+		FSimpleDelegate::CreateSP(m_SuggestionProvider.ToSharedRef(), &SuggestionProvider::CancelPendingQuery));
 
 	LoadDatabaseFromFile(PLUGIN_DATABASE_PATH);
+	m_SuggestionDatabase->OpenJournal(PLUGIN_JOURNAL_PATH);
+	m_NodeInformationDatabase->LoadFromFile(PLUGIN_NODE_INFORMATION_PATH);
+	m_DatabaseSaver = new SuggestionDatabaseSaver(*m_SuggestionDatabase, PLUGIN_DATABASE_PATH);
+	m_DatabaseReingester = new SuggestionDatabaseReingester(*m_SuggestionDatabase,
+		FSimpleDelegate::CreateSP(m_SuggestionProvider.ToSharedRef(), &SuggestionProvider::CancelPendingQuery));
 
 	IConsoleManager& consoleManager = IConsoleManager::Get();
 	m_RebuildCacheCommand = consoleManager.RegisterConsoleCommand(
 		TEXT("BIPlugin_RebuildSuggestionCache"),
-		TEXT("Flushes and Rebuilds blueprint suggestion cache based on all available blueprints in current project."),
+		TEXT("Rebuilds the blueprint suggestion cache in the background based on all available blueprints in current project. Reports progress while a rebuild is running."),
 		FConsoleCommandDelegate::CreateRaw(this, &BIPluginImpl::OnRebuildDatabase), 
 		ECVF_Default
 		);
@@ -39,17 +59,34 @@ void BIPluginImpl::StartupModule()
 		FConsoleCommandWithArgsDelegate::CreateRaw(this, &BIPluginImpl::OnPerformKFoldCrossValidation),
 		ECVF_Default
 		);
+	m_RunBenchmarkCommand = consoleManager.RegisterConsoleCommand(
+		TEXT("BIPlugin_RunBenchmark"),
+		TEXT("Runs synthetic performance benchmarks on the suggestion database. Optional argument: benchmark name (default: All)"),
+		FConsoleCommandWithArgsDelegate::CreateRaw(this, &BIPluginImpl::OnRunBenchmark),
+		ECVF_Default
+		);
 }
 
 void BIPluginImpl::ShutdownModule()
 {
+	if (IsRunningCommandlet())
+	{
+		return;
+	}
+
+	m_SuggestionProvider->CancelPendingQuery();
+	m_DatabaseRebuilder->CancelRebuild();
+	delete m_DatabaseReingester;
 	SaveDatabaseToFile(PLUGIN_DATABASE_PATH);
+	delete m_DatabaseSaver;
 
 	UE_LOG(BILog, Warning, TEXT("BIPlugin Shutdown"));
 
+	IConsoleManager::Get().UnregisterConsoleObject(m_RunBenchmarkCommand);
 	IConsoleManager::Get().UnregisterConsoleObject(m_PerformKFoldCrossValidationCommand);
 	IConsoleManager::Get().UnregisterConsoleObject(m_RebuildCacheCommand);
 	FBlueprintSuggestionProviderManager::Get().DeregisterBlueprintSuggestionProvider(m_SuggestionProvider);
+	delete m_DatabaseRebuilder;
 	m_SuggestionProvider.Reset();
 	delete m_SuggestionDatabase;
 	delete m_NodeInformationDatabase;
@@ -57,24 +94,27 @@ void BIPluginImpl::ShutdownModule()
 
 void BIPluginImpl::OnRebuildDatabase()
 {
-	UE_LOG(BILog, Warning, TEXT("Rebuilding suggestion database using available blueprints."));
-
-	m_NodeInformationDatabase->FlushDatabase();
-	m_NodeInformationDatabase->FillDatabase();
-
-	m_SuggestionDatabase->FlushDatabase();
-	m_SuggestionDatabase->FillSuggestionDatabase();
+	m_DatabaseRebuilder->StartRebuild();
 }
 
 void BIPluginImpl::SaveDatabaseToFile(const TCHAR* a_FilePath)
 {
 	UE_LOG(BILog, Log, TEXT("Serializing BI Plugin database to '%s'"), a_FilePath);
-	FArchive* fileArchive = IFileManager::Get().CreateFileWriter(a_FilePath);
-
-	m_SuggestionDatabase->Serialize(*fileArchive);
+	m_DatabaseSaver->WaitForPendingSave();
+	SuggestionDatabaseBase::SuggestionDatabaseSnapshotRef snapshot = m_SuggestionDatabase->CreateSnapshot();
+	if (SuggestionDatabaseSaver::WriteSnapshotToFile(*snapshot, a_FilePath))
+	{
+		m_SuggestionDatabase->CompactJournal(snapshot->GetJournalSequence());
+	}
+	else
+	{
+		m_SuggestionDatabase->MarkUnsaved();
+	}
 
-	fileArchive->Close();
-	delete fileArchive;
+	if (m_NodeInformationDatabase->HasUnsavedChanges())
+	{
+		m_NodeInformationDatabase->SaveToFile(PLUGIN_NODE_INFORMATION_PATH);
+	}
 }
 
 void BIPluginImpl::LoadDatabaseFromFile(const TCHAR* a_FilePath)
@@ -106,6 +146,8 @@ void BIPluginImpl::OnPerformKFoldCrossValidation(const TArray<FString>& a_Argume
 		int32 numFolds = FCString::Atoi(*a_Arguments[0]);
 		if (numFolds > 0)
 		{
+			m_SuggestionProvider->CancelPendingQuery();
+			m_DatabaseRebuilder->CancelRebuild();
 			m_SuggestionDatabase->PerformKFoldCrossValidationTest(numFolds);
 		}
 		else
@@ -115,4 +157,12 @@ void BIPluginImpl::OnPerformKFoldCrossValidation(const TArray<FString>& a_Argume
 	}
 }
 
+void BIPluginImpl::OnRunBenchmark(const TArray<FString>& a_Arguments)
+{
+	m_SuggestionProvider->CancelPendingQuery();
+	m_DatabaseRebuilder->CancelRebuild();
+	SuggestionDatabaseBenchmark benchmark(*static_cast<SuggestionDatabasePath*>(m_SuggestionDatabase));
+	benchmark.Run(a_Arguments);
+}
+
 IMPLEMENT_MODULE(BIPluginImpl, Module)
@@ -3,8 +3,11 @@
 #include "ModuleManager.h"
 
 class GraphNodeInformationDatabase;
-class IBlueprintSuggestionProvider;
+class SuggestionProvider;
 class SuggestionDatabaseBase;
+class SuggestionDatabaseRebuilder;
+class SuggestionDatabaseSaver;
+class SuggestionDatabaseReingester;
 class BIPluginImpl : public IModuleInterface
 {
 public:
@@ -17,12 +20,17 @@ public:
 	void LoadDatabaseFromFile(const TCHAR* a_FilePath);
 
 	void OnPerformKFoldCrossValidation(const TArray<FString>& a_Arguments);
+	void OnRunBenchmark(const TArray<FString>& a_Arguments);
 
 private:
-	TSharedPtr<IBlueprintSuggestionProvider> m_SuggestionProvider;
+	TSharedPtr<SuggestionProvider> m_SuggestionProvider;
 	SuggestionDatabaseBase* m_SuggestionDatabase;
 	GraphNodeInformationDatabase* m_NodeInformationDatabase;
+	SuggestionDatabaseRebuilder* m_DatabaseRebuilder;
+	SuggestionDatabaseSaver* m_DatabaseSaver;
+	SuggestionDatabaseReingester* m_DatabaseReingester;
 
 	IConsoleCommand* m_RebuildCacheCommand;
 	IConsoleCommand* m_PerformKFoldCrossValidationCommand;
+	IConsoleCommand* m_RunBenchmarkCommand;
 };
@@ -0,0 +1,89 @@
+#include "BIPluginPrivatePCH.h"
+#include "BIPluginIndexCommandlet.h"
+
+#include "AssetRegistryModule.h"
+#include "GraphNodeInformationDatabase.h"
+#include "SuggestionDatabasePath.h"
+#include "SuggestionDatabaseSaver.h"
+
+namespace
+{
+	const int32 DEFAULT_INDEX_BATCH_SIZE = 100;
+	const TCHAR* DEFAULT_INDEX_OUTPUT_PATH = TEXT("BIPluginData.bin");
+}
+
+UBIPluginIndexCommandlet::UBIPluginIndexCommandlet(const FObjectInitializer& a_ObjectInitializer)
+	: Super(a_ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UBIPluginIndexCommandlet::Main(const FString& a_Params)
+{
+	int32 batchSize = DEFAULT_INDEX_BATCH_SIZE;
+	FParse::Value(*a_Params, TEXT("BatchSize="), batchSize);
+	batchSize = FMath::Max(batchSize, 1);
+	FString outputPath = DEFAULT_INDEX_OUTPUT_PATH;
+	FParse::Value(*a_Params, TEXT("Output="), outputPath);
+
+	IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	assetRegistry.SearchAllAssets(true);
+	TArray<FAssetData> blueprintAssets;
+	assetRegistry.GetAssetsByClass(UBlueprint::StaticClass()->GetFName(), blueprintAssets, true);
+
+	UE_LOG(BILog, Display, TEXT("Indexing %i blueprints in batches of %i into '%s'"), blueprintAssets.Num(), batchSize, *outputPath);
+	const double startTime = FPlatformTime::Seconds();
+
+	//Node information is recorded while parsing, so the editor can filter suggestions without building template nodes.
+	GraphNodeInformationDatabase nodeInformationDatabase;
+	SuggestionDatabasePath database;
+	database.SetGraphNodeDatabase(&nodeInformationDatabase);
+	int32 numIndexed = 0;
+	for (int32 batchStart = 0; batchStart < blueprintAssets.Num(); batchStart += batchSize)
+	{
+		TArray<UBlueprint*> batch;
+		const int32 batchEnd = FMath::Min(batchStart + batchSize, blueprintAssets.Num());
+		for (int32 i = batchStart; i < batchEnd; ++i)
+		{
+			UBlueprint* blueprint = Cast<UBlueprint>(blueprintAssets[i].GetAsset());
+			if (blueprint != nullptr)
+			{
+				batch.Add(blueprint);
+			}
+			else
+			{
+				UE_LOG(BILog, Warning, TEXT("Could not load blueprint '%s', skipping it"), *blueprintAssets[i].ObjectPath.ToString());
+			}
+		}
+
+		database.ParseBlueprints(batch);
+		numIndexed += batch.Num();
+
+		//Only signature ids are kept in the database, so the parsed blueprints can be unloaded again.
+		batch.Empty();
+		CollectGarbage(RF_Native);
+
+		UE_LOG(BILog, Display, TEXT("Indexed %i of %i blueprints (%.1f s, %.1f MB used)"), batchEnd, blueprintAssets.Num(),
+			FPlatformTime::Seconds() - startTime, FPlatformMemory::GetStats().UsedPhysical / (1024.0f * 1024.0f));
+	}
+
+	if (!SuggestionDatabaseSaver::WriteSnapshotToFile(*database.CreateSnapshot(), outputPath))
+	{
+		return 1;
+	}
+
+	nodeInformationDatabase.SaveToFile(FPaths::ChangeExtension(outputPath, TEXT("nodeinfo")));
+
+	//Changes journaled by the editor belong to the database that was just replaced.
+	const FString journalPath = FPaths::ChangeExtension(outputPath, TEXT("wal"));
+	if (IFileManager::Get().FileExists(*journalPath))
+	{
+		IFileManager::Get().Delete(*journalPath);
+	}
+
+	UE_LOG(BILog, Display, TEXT("Indexed %i blueprints into '%s' in %.1f s"), numIndexed, *outputPath, FPlatformTime::Seconds() - startTime);
+	return 0;
+}
@@ -0,0 +1,157 @@
+#include "BIPluginPrivatePCH.h"
+#include "BlueprintContribution.h"
+
+namespace
+{
+	NodeSignatureTable::SignatureId RemapContributionId(NodeSignatureTable::SignatureId a_FileId,
+		const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds)
+	{
+		return (a_FileId < static_cast<uint32>(a_FileToTableIds.Num())) ? a_FileToTableIds[a_FileId] : NodeSignatureTable::INVALID_SIGNATURE_ID;
+	}
+}
+
+BlueprintContribution::EntryKey::EntryKey()
+	: m_AnchorId(NodeSignatureTable::INVALID_SIGNATURE_ID)
+	, m_PredictionId(NodeSignatureTable::INVALID_SIGNATURE_ID)
+	, m_ContextLength(0)
+	, m_Direction(0)
+{
+	for (NodeSignatureTable::SignatureId& contextId : m_ContextIds)
+	{
+		contextId = NodeSignatureTable::INVALID_SIGNATURE_ID;
+	}
+}
+
+BlueprintContribution::EntryKey::EntryKey(const PathPredictionEntry& a_Entry)
+	: m_AnchorId(a_Entry.m_AnchorVertex.m_SignatureId)
+	, m_PredictionId(a_Entry.m_PredictionVertex.m_SignatureId)
+	, m_ContextLength(static_cast<uint8>(a_Entry.m_ContextPath.Num()))
+	, m_Direction(static_cast<uint8>(a_Entry.m_Direction))
+{
+	for (int32 i = 0; i < PathContextPath::MAX_CONTEXT_PATH_LENGTH; ++i)
+	{
+		m_ContextIds[i] = (i < m_ContextLength) ? a_Entry.m_ContextPath.GetNode(i).m_SignatureId : NodeSignatureTable::INVALID_SIGNATURE_ID;
+	}
+}
+
+bool BlueprintContribution::EntryKey::operator ==(const EntryKey& a_Other) const
+{
+	//Unused context slots are always invalid, so comparing every slot also compares the lengths.
+	return m_AnchorId == a_Other.m_AnchorId && m_PredictionId == a_Other.m_PredictionId && m_Direction == a_Other.m_Direction &&
+		FMemory::Memcmp(m_ContextIds, a_Other.m_ContextIds, sizeof(m_ContextIds)) == 0;
+}
+
+uint32 GetTypeHash(const BlueprintContribution::EntryKey& a_Instance)
+{
+	return FCrc::MemCrc32(a_Instance.m_ContextIds, sizeof(a_Instance.m_ContextIds),
+		a_Instance.m_AnchorId ^ (a_Instance.m_PredictionId * 31) ^ (a_Instance.m_Direction << 30));
+}
+
+void BlueprintContribution::EntryKey::ToEntry(PathPredictionEntry& a_OutEntry) const
+{
+	a_OutEntry.m_Direction = static_cast<EPathDirection>(m_Direction);
+	a_OutEntry.m_AnchorVertex = PathNodeEntry(m_AnchorId);
+	a_OutEntry.m_PredictionVertex = PathNodeEntry(m_PredictionId);
+	a_OutEntry.m_ContextPath.Reset(m_ContextLength);
+	for (int32 i = 0; i < m_ContextLength; ++i)
+	{
+		a_OutEntry.m_ContextPath.SetNode(i, PathNodeEntry(m_ContextIds[i]));
+	}
+}
+
+BlueprintContribution::BlueprintContribution()
+{
+}
+
+BlueprintContribution::~BlueprintContribution()
+{
+}
+
+void BlueprintContribution::AddUses(const PathPredictionEntry& a_Delta)
+{
+	const EntryKey key(a_Delta);
+	int32* numUses = m_Uses.Find(key);
+	if (numUses != nullptr)
+	{
+		if (*numUses + a_Delta.m_NumUses <= 0)
+		{
+			m_Uses.Remove(key);
+		}
+		else
+		{
+			*numUses += a_Delta.m_NumUses;
+		}
+	}
+	else if (a_Delta.m_NumUses > 0)
+	{
+		m_Uses.Add(key, a_Delta.m_NumUses);
+	}
+}
+
+int32 BlueprintContribution::Num() const
+{
+	return m_Uses.Num();
+}
+
+void BlueprintContribution::RemapSignatureIds(const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds)
+{
+	TMap<EntryKey, int32> remappedUses;
+	remappedUses.Reserve(m_Uses.Num());
+	for (const auto& use : m_Uses)
+	{
+		EntryKey key = use.Key;
+		key.m_AnchorId = RemapContributionId(key.m_AnchorId, a_FileToTableIds);
+		key.m_PredictionId = RemapContributionId(key.m_PredictionId, a_FileToTableIds);
+		for (int32 i = 0; i < key.m_ContextLength; ++i)
+		{
+			key.m_ContextIds[i] = RemapContributionId(key.m_ContextIds[i], a_FileToTableIds);
+		}
+		remappedUses.Add(key, use.Value);
+	}
+	Exchange(m_Uses, remappedUses);
+}
+
+FArchive& operator << (FArchive& a_Archive, BlueprintContribution& a_Value)
+{
+	//Only the used context slots are stored, the ids are those of the signature table of the database file.
+	int32 numEntries = a_Value.m_Uses.Num();
+	a_Archive << numEntries;
+	if (a_Archive.IsLoading())
+	{
+		a_Value.m_Uses.Empty(numEntries);
+		for (int32 i = 0; i < numEntries && !a_Archive.IsError(); ++i)
+		{
+			BlueprintContribution::EntryKey key;
+			int32 numUses = 0;
+			a_Archive << key.m_Direction << key.m_AnchorId << key.m_PredictionId << key.m_ContextLength;
+			if (key.m_Direction > static_cast<uint8>(EPathDirection::Backward) || key.m_ContextLength > PathContextPath::MAX_CONTEXT_PATH_LENGTH)
+			{
+				a_Archive.ArIsError = true;
+				break;
+			}
+			for (int32 contextIndex = 0; contextIndex < key.m_ContextLength; ++contextIndex)
+			{
+				a_Archive << key.m_ContextIds[contextIndex];
+			}
+			a_Archive << numUses;
+			if (numUses > 0)
+			{
+				a_Value.m_Uses.Add(key, numUses);
+			}
+		}
+	}
+	else
+	{
+		for (auto& use : a_Value.m_Uses)
+		{
+			BlueprintContribution::EntryKey key = use.Key;
+			a_Archive << key.m_Direction << key.m_AnchorId << key.m_PredictionId << key.m_ContextLength;
+			for (int32 contextIndex = 0; contextIndex < key.m_ContextLength; ++contextIndex)
+			{
+				a_Archive << key.m_ContextIds[contextIndex];
+			}
+			a_Archive << use.Value;
+		}
+	}
+	return a_Archive;
+}
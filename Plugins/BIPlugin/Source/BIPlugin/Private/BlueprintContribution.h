@@ -0,0 +1,54 @@
+#pragma once
+
+#include "PathPredictionEntry.h"
+
+/** The uses a single blueprint added to the prediction databases, so they can be subtracted again when it is re-parsed.
+ * Only keeps a use count per (direction, anchor, prediction, context), without the indices a PathPredictionList needs for queries */
+class BlueprintContribution
+{
+public:
+	/** Fixed size copy of the key fields of a PathPredictionEntry, unused context slots are INVALID_SIGNATURE_ID */
+	struct EntryKey
+	{
+		EntryKey();
+		EntryKey(const PathPredictionEntry& a_Entry);
+		bool operator == (const EntryKey& a_Other) const;
+		friend uint32 GetTypeHash(const EntryKey& a_Instance);
+		void ToEntry(PathPredictionEntry& a_OutEntry) const;
+
+		NodeSignatureTable::SignatureId m_AnchorId;
+		NodeSignatureTable::SignatureId m_PredictionId;
+		NodeSignatureTable::SignatureId m_ContextIds[PathContextPath::MAX_CONTEXT_PATH_LENGTH];
+		uint8 m_ContextLength;
+		uint8 m_Direction;
+	};
+
+	BlueprintContribution();
+	~BlueprintContribution();
+
+	/** Adds the uses of a_Delta to the matching entry. Negative uses are subtracted, entries left without uses are removed */
+	void AddUses(const PathPredictionEntry& a_Delta);
+	int32 Num() const;
+	/** Calls a_Visitor with every entry and its summed uses */
+	template<typename VISITOR>
+	void ForEachEntry(VISITOR a_Visitor) const;
+	/** Ids outside of a_FileToTableIds become NodeSignatureTable::INVALID_SIGNATURE_ID */
+	void RemapSignatureIds(const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds);
+
+	friend FArchive& operator << (FArchive& a_Archive, BlueprintContribution& a_Value);
+
+private:
+	TMap<EntryKey, int32> m_Uses;
+};
+
+template<typename VISITOR>
+void BlueprintContribution::ForEachEntry(VISITOR a_Visitor) const
+{
+	PathPredictionEntry entry;
+	for (const auto& use : m_Uses)
+	{
+		use.Key.ToEntry(entry);
+		entry.m_NumUses = use.Value;
+		a_Visitor(entry);
+	}
+}
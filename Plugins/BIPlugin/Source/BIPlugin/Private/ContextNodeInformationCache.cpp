@@ -0,0 +1,176 @@
+#include "BIPluginPrivatePCH.h"
+#include "ContextNodeInformationCache.h"
+
+#include "Kismet2/BlueprintEditorUtils.h"
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarContextNodeInformationCacheSize(
+		TEXT("BIPlugin.ContextNodeInformationCacheSize"),
+		4096,
+		TEXT("Maximum number of context specific node information entries kept for the suggestion compatibility filter"),
+		ECVF_Default);
+}
+
+ContextNodeInformationCache::ContextKey::ContextKey(const FGuid& a_SignatureGuid, FName a_Context)
+	: m_SignatureGuid(a_SignatureGuid)
+	, m_Context(a_Context)
+{
+}
+
+bool ContextNodeInformationCache::ContextKey::operator ==(const ContextKey& a_Other) const
+{
+	return m_SignatureGuid == a_Other.m_SignatureGuid && m_Context == a_Other.m_Context;
+}
+
+uint32 GetTypeHash(const ContextNodeInformationCache::ContextKey& a_Instance)
+{
+	return GetTypeHash(a_Instance.m_SignatureGuid) ^ (GetTypeHash(a_Instance.m_Context) * 31);
+}
+
+ContextNodeInformationCache::CacheEntry::CacheEntry(const ContextKey& a_Key, const GraphNodeInformation& a_NodeInfo)
+	: m_Key(a_Key)
+	, m_NodeInfo(a_NodeInfo)
+	, m_Newer(INDEX_NONE)
+	, m_Older(INDEX_NONE)
+{
+}
+
+ContextNodeInformationCache::ContextNodeInformationCache()
+	: m_Newest(INDEX_NONE)
+	, m_Oldest(INDEX_NONE)
+{
+}
+
+ContextNodeInformationCache::~ContextNodeInformationCache()
+{
+}
+
+FName ContextNodeInformationCache::GetGraphContext(const UEdGraph& a_Graph)
+{
+	//Self context variables resolve against the blueprint, so every graph of a blueprint shares its context.
+	const UBlueprint* blueprint = FBlueprintEditorUtils::FindBlueprintForGraph(&a_Graph);
+	return FName(*((blueprint != nullptr) ? blueprint->GetPathName() : a_Graph.GetPathName()));
+}
+
+const GraphNodeInformation* ContextNodeInformationCache::Find(const ContextKey& a_Key)
+{
+	const int32* entryIndex = m_EntryIndices.Find(a_Key);
+	if (entryIndex == nullptr)
+	{
+		return nullptr;
+	}
+
+	const int32 index = *entryIndex;
+	if (index != m_Newest)
+	{
+		Unlink(index);
+		Link(index);
+	}
+	return &m_Entries[index].m_NodeInfo;
+}
+
+void ContextNodeInformationCache::Add(const ContextKey& a_Key, const GraphNodeInformation& a_NodeInfo)
+{
+	const int32* entryIndex = m_EntryIndices.Find(a_Key);
+	if (entryIndex != nullptr)
+	{
+		m_Entries[*entryIndex].m_NodeInfo = a_NodeInfo;
+		Find(a_Key);
+		return;
+	}
+
+	const int32 maxEntries = FMath::Max(CVarContextNodeInformationCacheSize.GetValueOnGameThread(), 1);
+	while (m_Entries.Num() >= maxEntries)
+	{
+		EvictOldest();
+	}
+
+	const int32 index = m_Entries.Add(CacheEntry(a_Key, a_NodeInfo));
+	m_EntryIndices.Add(a_Key, index);
+	Link(index);
+}
+
+int32 ContextNodeInformationCache::Num() const
+{
+	return m_Entries.Num();
+}
+
+void ContextNodeInformationCache::Empty()
+{
+	m_Entries.Empty();
+	m_EntryIndices.Empty();
+	m_Newest = INDEX_NONE;
+	m_Oldest = INDEX_NONE;
+}
+
+void ContextNodeInformationCache::Link(int32 a_Index)
+{
+	CacheEntry& entry = m_Entries[a_Index];
+	entry.m_Newer = INDEX_NONE;
+	entry.m_Older = m_Newest;
+	if (m_Newest != INDEX_NONE)
+	{
+		m_Entries[m_Newest].m_Newer = a_Index;
+	}
+	m_Newest = a_Index;
+	if (m_Oldest == INDEX_NONE)
+	{
+		m_Oldest = a_Index;
+	}
+}
+
+void ContextNodeInformationCache::Unlink(int32 a_Index)
+{
+	CacheEntry& entry = m_Entries[a_Index];
+	if (entry.m_Newer != INDEX_NONE)
+	{
+		m_Entries[entry.m_Newer].m_Older = entry.m_Older;
+	}
+	else
+	{
+		m_Newest = entry.m_Older;
+	}
+	if (entry.m_Older != INDEX_NONE)
+	{
+		m_Entries[entry.m_Older].m_Newer = entry.m_Newer;
+	}
+	else
+	{
+		m_Oldest = entry.m_Newer;
+	}
+	entry.m_Newer = INDEX_NONE;
+	entry.m_Older = INDEX_NONE;
+}
+
+void ContextNodeInformationCache::EvictOldest()
+{
+	const int32 evictedIndex = m_Oldest;
+	Unlink(evictedIndex);
+	m_EntryIndices.Remove(m_Entries[evictedIndex].m_Key);
+
+	//The last entry takes the evicted slot, so its neighbours and index have to point to the new slot.
+	const int32 lastIndex = m_Entries.Num() - 1;
+	m_Entries.RemoveAtSwap(evictedIndex);
+	if (evictedIndex != lastIndex)
+	{
+		const CacheEntry& movedEntry = m_Entries[evictedIndex];
+		if (movedEntry.m_Newer != INDEX_NONE)
+		{
+			m_Entries[movedEntry.m_Newer].m_Older = evictedIndex;
+		}
+		else
+		{
+			m_Newest = evictedIndex;
+		}
+		if (movedEntry.m_Older != INDEX_NONE)
+		{
+			m_Entries[movedEntry.m_Older].m_Newer = evictedIndex;
+		}
+		else
+		{
+			m_Oldest = evictedIndex;
+		}
+		m_EntryIndices.FindChecked(movedEntry.m_Key) = evictedIndex;
+	}
+}
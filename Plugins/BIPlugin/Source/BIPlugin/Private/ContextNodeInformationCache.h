@@ -0,0 +1,52 @@
+#pragma once
+
+#include "GraphNodeInformation.h"
+
+/** Node information for context specific nodes, keyed on signature and the blueprint or graph the node is placed in.
+ * Holds at most BIPlugin.ContextNodeInformationCacheSize entries, the least recently used entry is evicted first. Game thread only. */
+class ContextNodeInformationCache
+{
+public:
+	struct ContextKey
+	{
+		ContextKey(const FGuid& a_SignatureGuid, FName a_Context);
+		bool operator == (const ContextKey& a_Other) const;
+		friend uint32 GetTypeHash(const ContextKey& a_Instance);
+
+		FGuid m_SignatureGuid;
+		FName m_Context;
+	};
+
+	ContextNodeInformationCache();
+	~ContextNodeInformationCache();
+
+	/** Name context specific information for nodes in a_Graph is stored under */
+	static FName GetGraphContext(const UEdGraph& a_Graph);
+
+	/** Returns the cached information and marks it as most recently used, or nullptr */
+	const GraphNodeInformation* Find(const ContextKey& a_Key);
+	/** Adds or replaces the information for a_Key, evicting the least recently used entries if the cache is full */
+	void Add(const ContextKey& a_Key, const GraphNodeInformation& a_NodeInfo);
+	int32 Num() const;
+	void Empty();
+
+private:
+	struct CacheEntry
+	{
+		CacheEntry(const ContextKey& a_Key, const GraphNodeInformation& a_NodeInfo);
+
+		ContextKey m_Key;
+		GraphNodeInformation m_NodeInfo;
+		int32 m_Newer;
+		int32 m_Older;
+	};
+
+	void Link(int32 a_Index);
+	void Unlink(int32 a_Index);
+	void EvictOldest();
+
+	TArray<CacheEntry> m_Entries;
+	TMap<ContextKey, int32> m_EntryIndices;
+	int32 m_Newest;
+	int32 m_Oldest;
+};
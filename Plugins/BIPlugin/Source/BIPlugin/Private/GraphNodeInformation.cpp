@@ -3,54 +3,106 @@
 
 namespace
 {
-	void DiscoverNodePinTypes(const UK2Node& a_Node, EEdGraphPinDirection a_PinDirection, TArray<FEdGraphPinType>& a_Output)
+	void DiscoverNodePinTypes(const UK2Node& a_Node, EEdGraphPinDirection a_PinDirection, TArray<PinTypeTable::PinTypeId>& a_Output)
 	{
+		PinTypeTable& pinTypeTable = PinTypeTable::Get();
 		for (UEdGraphPin* pin : a_Node.Pins)
 		{
 			if (pin->Direction == a_PinDirection)
 			{
-				a_Output.Push(FEdGraphPinType(pin->PinType));
+				a_Output.AddUnique(pinTypeTable.FindOrAdd(pin->PinType));
 			}
 		}
+		a_Output.Sort();
+		a_Output.Shrink();
 	}
-}
 
-GraphNodeInformation::GraphNodeInformation(UK2Node& a_Node)
-{
-	if (a_Node.Pins.Num() == 0)
+	void RemapNodePinTypes(const TArray<PinTypeTable::PinTypeId>& a_FileToTableIds, TArray<PinTypeTable::PinTypeId>& a_PinTypes)
 	{
-		a_Node.AllocateDefaultPins();
-		UE_LOG(BILog, Warning, TEXT("Allocating default pins for node %s"), *a_Node.
-			GetNodeTitle(ENodeTitleType::MenuTitle).ToString());
+		for (PinTypeTable::PinTypeId& pinType : a_PinTypes)
+		{
+			pinType = a_FileToTableIds.IsValidIndex(pinType) ? a_FileToTableIds[pinType] : pinType;
+		}
+		//Ids of the table the file was written with may be ordered differently.
+		a_PinTypes.Sort();
 	}
+}
+
+GraphNodeInformation::GraphNodeInformation()
+	: m_IsContextSpecific(false)
+{
+}
+
+GraphNodeInformation::GraphNodeInformation(const UK2Node& a_Node)
+{
+	DiscoverNodePinTypes(a_Node, EEdGraphPinDirection::EGPD_Input, m_InputPinTypes);
+	DiscoverNodePinTypes(a_Node, EEdGraphPinDirection::EGPD_Output, m_OutputPinTypes);
 
-	DiscoverNodePinTypes(a_Node, EEdGraphPinDirection::EGPD_Input, m_InputPins);
-	DiscoverNodePinTypes(a_Node, EEdGraphPinDirection::EGPD_Output, m_OutputPins);
+	const PinTypeTable::PinTypeId wildcardPinType = PinTypeTable::Get().GetWildcardPinType();
+	const UK2Node_Variable* variableNode = Cast<const UK2Node_Variable>(&a_Node);
+	m_IsContextSpecific = (variableNode != nullptr && variableNode->VariableReference.IsSelfContext()) ||
+		HasPinTypeInDirection(wildcardPinType, EEdGraphPinDirection::EGPD_Input) || 
+		HasPinTypeInDirection(wildcardPinType, EEdGraphPinDirection::EGPD_Output);
 }
 
 GraphNodeInformation::~GraphNodeInformation()
 {	
 }
 
-const TArray<FEdGraphPinType>& GraphNodeInformation::GetInputPins() const
+const TArray<PinTypeTable::PinTypeId>& GraphNodeInformation::GetInputPinTypes() const
+{
+	return m_InputPinTypes;
+}
+
+const TArray<PinTypeTable::PinTypeId>& GraphNodeInformation::GetOutputPinTypes() const
+{
+	return m_OutputPinTypes;
+}
+
+bool GraphNodeInformation::HasPinTypeInDirection(PinTypeTable::PinTypeId a_PinType, EEdGraphPinDirection a_Direction) const
+{
+	//Binary search; nodes rarely have more than a handful of distinct pin types, so this is a few integer compares.
+	const TArray<PinTypeTable::PinTypeId>& pinTypes = GetPinTypesForDirection(a_Direction);
+	int32 first = 0;
+	int32 last = pinTypes.Num();
+	while (first < last)
+	{
+		const int32 middle = first + (last - first) / 2;
+		if (pinTypes[middle] < a_PinType)
+		{
+			first = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	return first < pinTypes.Num() && pinTypes[first] == a_PinType;
+}
+
+bool GraphNodeInformation::AcceptsPinTypeInDirection(PinTypeTable::PinTypeId a_PinType, EEdGraphPinDirection a_Direction) const
+{
+	return HasPinTypeInDirection(a_PinType, a_Direction) || HasPinTypeInDirection(PinTypeTable::Get().GetWildcardPinType(), a_Direction);
+}
+
+bool GraphNodeInformation::IsContextSpecific() const
 {
-	return m_InputPins;
+	return m_IsContextSpecific;
 }
 
-const TArray<FEdGraphPinType>& GraphNodeInformation::GetOutputPins() const
+void GraphNodeInformation::RemapPinTypeIds(const TArray<PinTypeTable::PinTypeId>& a_FileToTableIds)
 {
-	return m_OutputPins;
+	RemapNodePinTypes(a_FileToTableIds, m_InputPinTypes);
+	RemapNodePinTypes(a_FileToTableIds, m_OutputPinTypes);
 }
 
-bool GraphNodeInformation::HasPinTypeInDirection(const FEdGraphPinType& a_PinType, EEdGraphPinDirection a_Direction) const
+FArchive& operator << (FArchive& a_Archive, GraphNodeInformation& a_Value)
 {
-	const TArray<FEdGraphPinType>& pinData = GetPinArrayForDirection(a_Direction);
-	return pinData.ContainsByPredicate([&](const FEdGraphPinType& obj) -> bool {
-		return obj.PinCategory == a_PinType.PinCategory && obj.PinSubCategoryObject == a_PinType.PinSubCategoryObject;
-	});
+	a_Archive << a_Value.m_InputPinTypes << a_Value.m_OutputPinTypes << a_Value.m_IsContextSpecific;
+	return a_Archive;
 }
 
-const TArray<FEdGraphPinType>& GraphNodeInformation::GetPinArrayForDirection(EEdGraphPinDirection a_Direction) const
+const TArray<PinTypeTable::PinTypeId>& GraphNodeInformation::GetPinTypesForDirection(EEdGraphPinDirection a_Direction) const
 {
-	return a_Direction == EEdGraphPinDirection::EGPD_Input ? m_InputPins : m_OutputPins;
+	return a_Direction == EEdGraphPinDirection::EGPD_Input ? m_InputPinTypes : m_OutputPinTypes;
 }
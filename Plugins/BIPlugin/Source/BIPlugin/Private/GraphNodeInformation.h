@@ -1,21 +1,33 @@
 #pragma once
 
-#include "EdGraph/EdGraphPin.h"
+#include "PinTypeTable.h"
 
 class GraphNodeInformation
 {
 public:
-	GraphNodeInformation(UK2Node& a_Node);
+	GraphNodeInformation();
+	/** a_Node needs its pins allocated */
+	GraphNodeInformation(const UK2Node& a_Node);
 	~GraphNodeInformation();
 
-	const TArray<FEdGraphPinType>& GetInputPins() const;
-	const TArray<FEdGraphPinType>& GetOutputPins() const;
+	/** Sorted, unique ids of the pin types of the input pins */
+	const TArray<PinTypeTable::PinTypeId>& GetInputPinTypes() const;
+	/** Sorted, unique ids of the pin types of the output pins */
+	const TArray<PinTypeTable::PinTypeId>& GetOutputPinTypes() const;
 
-	bool HasPinTypeInDirection(const FEdGraphPinType& a_PinType, EEdGraphPinDirection a_Direction) const;
+	bool HasPinTypeInDirection(PinTypeTable::PinTypeId a_PinType, EEdGraphPinDirection a_Direction) const;
+	/** Like HasPinTypeInDirection, but wildcard pins accept any pin type */
+	bool AcceptsPinTypeInDirection(PinTypeTable::PinTypeId a_PinType, EEdGraphPinDirection a_Direction) const;
+	/** Whether the pins of this node depend on the graph it is placed in, e.g. through wildcard pins or a self context variable */
+	bool IsContextSpecific() const;
+	void RemapPinTypeIds(const TArray<PinTypeTable::PinTypeId>& a_FileToTableIds);
+
+	friend FArchive& operator << (FArchive& a_Archive, GraphNodeInformation& a_Value);
 
 private:
-	const TArray<FEdGraphPinType>& GetPinArrayForDirection(EEdGraphPinDirection a_Direction) const;
+	const TArray<PinTypeTable::PinTypeId>& GetPinTypesForDirection(EEdGraphPinDirection a_Direction) const;
 
-	TArray<FEdGraphPinType> m_InputPins;
-	TArray<FEdGraphPinType> m_OutputPins;
+	TArray<PinTypeTable::PinTypeId> m_InputPinTypes;
+	TArray<PinTypeTable::PinTypeId> m_OutputPinTypes;
+	bool m_IsContextSpecific;
 };
@@ -1,93 +1,326 @@
 #include "BIPluginPrivatePCH.h"
 #include "GraphNodeInformationDatabase.h"
-#include "BlueprintActionDatabase.h"
+#include "BlueprintNodeSpawner.h"
 #include "GraphNodeInformation.h"
+#include "NodeSignatureCache.h"
 
 namespace
 {
-	UK2Node* FindTemplateNodeForNodeGuid(const FGuid& a_NodeSignatureGuid, UEdGraph* a_OwningGraph)
+	const uint32 NODE_INFORMATION_CACHE_VERSION = 2;
+}
+
+GraphNodeInformationDatabase::GraphNodeInformationDatabase()
+	: m_HasUnsavedChanges(false)
+	, m_ResolvedSpawnerRevision(0)
+	, m_NumIndexedSignatures(0)
+{
+}
+
+GraphNodeInformationDatabase::~GraphNodeInformationDatabase()
+{
+}
+
+const GraphNodeInformation* GraphNodeInformationDatabase::FindNodeInformation(const FGuid& a_NodeSignatureGuid, UEdGraph* a_TargetGraph)
+{
+	const GraphNodeInformation* info = FindContextFreeNodeInformation(a_NodeSignatureGuid, a_TargetGraph);
+	if (info != nullptr && info->IsContextSpecific() && a_TargetGraph != nullptr)
 	{
-		UK2Node* result = nullptr;
-		FBlueprintActionDatabase::FActionRegistry const& actionDatabase = FBlueprintActionDatabase::Get().GetAllActions();
-		for (auto const& actionEntry : actionDatabase)
+		//Nodes recorded in the same blueprint are preferred over the template, they match what the user works with.
+		const ContextNodeInformationCache::ContextKey contextKey(a_NodeSignatureGuid, ContextNodeInformationCache::GetGraphContext(*a_TargetGraph));
+		const GraphNodeInformation* contextInfo = m_ContextNodeInformation.Find(contextKey);
+		if (contextInfo == nullptr)
 		{
-			for (UBlueprintNodeSpawner const* nodeSpawner : actionEntry.Value)
+			GraphNodeInformation nodeInfo;
+			if (BuildTemplateNodeInformation(a_NodeSignatureGuid, a_TargetGraph, nodeInfo))
 			{
-				UEdGraphNode* nodeTemplate = nodeSpawner->GetTemplateNode(a_OwningGraph);
-				if (nodeTemplate != nullptr && nodeTemplate->IsA(UK2Node::StaticClass()))
-				{
-					UK2Node* ukNode = Cast<UK2Node>(nodeTemplate);
-					if (ukNode->GetSignature().AsGuid() == a_NodeSignatureGuid)
-					{
-						result = ukNode;
-						break;
-					}
-				}
+				m_ContextNodeInformation.Add(contextKey, nodeInfo);
+				contextInfo = m_ContextNodeInformation.Find(contextKey);
 			}
+		}
+		info = (contextInfo != nullptr) ? contextInfo : info;
+	}
+
+	return info;
+}
+
+const GraphNodeInformation* GraphNodeInformationDatabase::FindNodeInformation(const FGuid& a_NodeSignatureGuid) const
+{
+	return m_GraphNodeInformation.Find(a_NodeSignatureGuid);
+}
 
-			if (result != nullptr)
+void GraphNodeInformationDatabase::RecordNodeInformation(const UEdGraph& a_Graph)
+{
+	TArray<UK2Node*> nodes;
+	a_Graph.GetNodesOfClass(nodes);
+	const FName graphContext = ContextNodeInformationCache::GetGraphContext(a_Graph);
+	for (const UK2Node* node : nodes)
+	{
+		//Nodes placed in a graph have their pins allocated, unlike templates.
+		const FGuid signatureGuid = NodeSignatureCache::Get().GetSignatureGuid(*node);
+		const GraphNodeInformation* knownInfo = m_GraphNodeInformation.Find(signatureGuid);
+		if (knownInfo != nullptr && !knownInfo->IsContextSpecific())
+		{
+			continue;
+		}
+
+		const GraphNodeInformation nodeInfo(*node);
+		if (nodeInfo.IsContextSpecific())
+		{
+			m_ContextNodeInformation.Add(ContextNodeInformationCache::ContextKey(signatureGuid, graphContext), nodeInfo);
+		}
+		if (knownInfo == nullptr)
+		{
+			FScopeLock lock(&m_RecordedNodeInformationLock);
+			if (!m_RecordedNodeInformation.Contains(signatureGuid))
 			{
-				break;
+				m_RecordedNodeInformation.Add(signatureGuid, nodeInfo);
 			}
 		}
-		return result;
 	}
 }
 
-GraphNodeInformationDatabase::GraphNodeInformationDatabase()
-	: m_HasBuiltDatabase(false)
+bool GraphNodeInformationDatabase::HasUnsavedChanges() const
 {
+	FScopeLock lock(&m_RecordedNodeInformationLock);
+	return m_HasUnsavedChanges || m_RecordedNodeInformation.Num() > 0;
 }
 
-GraphNodeInformationDatabase::~GraphNodeInformationDatabase()
+void GraphNodeInformationDatabase::Serialize(FArchive& a_Archive)
 {
-}
+	uint32 version = NODE_INFORMATION_CACHE_VERSION;
+	a_Archive << version;
+	if (a_Archive.IsLoading() && version != NODE_INFORMATION_CACHE_VERSION)
+	{
+		UE_LOG(BILog, Warning, TEXT("Ignoring node information cache of version %u, expected %u"), version, NODE_INFORMATION_CACHE_VERSION);
+		return;
+	}
 
-void GraphNodeInformationDatabase::FillDatabase()
-{
-	FBlueprintActionDatabase::FActionRegistry const& actionDatabase = FBlueprintActionDatabase::Get().GetAllActions();
-	for (auto const& actionEntry : actionDatabase)
+	MergeRecordedNodeInformation();
+
+	//Pin type ids are only valid for the table they were interned in, so the table is stored along.
+	TArray<PinTypeTable::PinTypeId> fileToTableIds;
+	PinTypeTable::Get().Serialize(a_Archive, fileToTableIds);
+
+	if (a_Archive.IsLoading())
 	{
-		for (UBlueprintNodeSpawner const* nodeSpawner : actionEntry.Value)
+		TMap<FGuid, GraphNodeInformation> loadedNodeInformation;
+		a_Archive << loadedNodeInformation;
+		for (auto& loadedEntry : loadedNodeInformation)
 		{
-			UEdGraphNode* nodeTemplate = nodeSpawner->GetTemplateNode();
-			if (nodeTemplate != nullptr && nodeTemplate->IsA(UK2Node::StaticClass()))
+			if (!m_GraphNodeInformation.Contains(loadedEntry.Key))
 			{
-				UK2Node* ukNode = Cast<UK2Node>(nodeTemplate);
-				
-				FBlueprintNodeSignature signature = ukNode->GetSignature();
-				FGuid nodeSignatureGuid = signature.AsGuid();
-				
-				GraphNodeInformation nodeInfo(*ukNode);
-
-				m_GraphNodeInformation.Add(nodeSignatureGuid, nodeInfo);
+				loadedEntry.Value.RemapPinTypeIds(fileToTableIds);
+				m_GraphNodeInformation.Add(loadedEntry.Key, loadedEntry.Value);
 			}
 		}
+		//Unresolved signatures may be covered by the cache now.
+		m_UnresolvedSignatures.Reset();
+		ResetCompatibilityIndex();
+	}
+	else
+	{
+		a_Archive << m_GraphNodeInformation;
+		m_HasUnsavedChanges = false;
 	}
-	m_HasBuiltDatabase = true;
 }
 
-void GraphNodeInformationDatabase::FlushDatabase()
+bool GraphNodeInformationDatabase::LoadFromFile(const FString& a_FilePath)
 {
-	m_GraphNodeInformation.Empty();
-	m_HasBuiltDatabase = false;
+	FArchive* fileArchive = IFileManager::Get().CreateFileReader(*a_FilePath);
+	if (fileArchive == nullptr)
+	{
+		UE_LOG(BILog, Log, TEXT("Could not find node information cache at '%s'"), *a_FilePath);
+		return false;
+	}
+
+	Serialize(*fileArchive);
+	fileArchive->Close();
+	delete fileArchive;
+	UE_LOG(BILog, Log, TEXT("Loaded node information for %i signatures from '%s'"), m_GraphNodeInformation.Num(), *a_FilePath);
+	return true;
 }
 
-const GraphNodeInformation* GraphNodeInformationDatabase::FindNodeInformation(const FGuid& a_NodeSignatureGuid, UEdGraph* a_TargetGraph)
+bool GraphNodeInformationDatabase::SaveToFile(const FString& a_FilePath)
+{
+	const FString temporaryFilePath = a_FilePath + TEXT(".tmp");
+	FArchive* fileArchive = IFileManager::Get().CreateFileWriter(*temporaryFilePath);
+	if (fileArchive == nullptr)
+	{
+		UE_LOG(BILog, Warning, TEXT("Could not open '%s' to save the node information cache"), *temporaryFilePath);
+		return false;
+	}
+
+	Serialize(*fileArchive);
+	const bool wroteFile = fileArchive->Close();
+	delete fileArchive;
+
+	if (!wroteFile || !IFileManager::Get().Move(*a_FilePath, *temporaryFilePath, true, true))
+	{
+		UE_LOG(BILog, Warning, TEXT("Could not save the node information cache to '%s'"), *a_FilePath);
+		IFileManager::Get().Delete(*temporaryFilePath);
+		m_HasUnsavedChanges = true;
+		return false;
+	}
+	return true;
+}
+
+void GraphNodeInformationDatabase::UpdateCompatibilityIndex(UEdGraph* a_ContextGraph)
+{
+	if (MergeRecordedNodeInformation() || m_ResolvedSpawnerRevision != m_SpawnerIndex.GetRevision())
+	{
+		ResolveSignatures(a_ContextGraph);
+	}
+
+	NodeSignatureTable& signatureTable = NodeSignatureTable::Get();
+	const NodeSignatureTable::SignatureId numSignatures = static_cast<NodeSignatureTable::SignatureId>(signatureTable.Num());
+	if (m_NumIndexedSignatures == 0)
+	{
+		m_NumIndexedSignatures = NodeSignatureTable::INVALID_SIGNATURE_ID + 1;
+	}
+
+	for (NodeSignatureTable::SignatureId id = m_NumIndexedSignatures; id < numSignatures; ++id)
+	{
+		const GraphNodeInformation* nodeInfo = FindContextFreeNodeInformation(signatureTable.GetSignatureGuid(id), a_ContextGraph);
+		if (nodeInfo != nullptr)
+		{
+			IndexSignature(id, *nodeInfo);
+		}
+		else
+		{
+			m_UnresolvedSignatures.Add(id);
+		}
+	}
+	m_NumIndexedSignatures = FMath::Max(m_NumIndexedSignatures, numSignatures);
+}
+
+void GraphNodeInformationDatabase::CheckContextSpecificSignatures(const TArray<NodeSignatureTable::SignatureId>& a_SortedSignatures,
+	PinTypeTable::PinTypeId a_PinType, EEdGraphPinDirection a_Direction, UEdGraph* a_ContextGraph,
+	TArray<NodeSignatureTable::SignatureId>& a_OutContextSpecific, TArray<NodeSignatureTable::SignatureId>& a_OutCompatible)
+{
+	NodeSignatureTable::IntersectSorted(a_SortedSignatures, m_ContextSpecificSignatures, a_OutContextSpecific);
+	for (NodeSignatureTable::SignatureId id : a_OutContextSpecific)
+	{
+		const GraphNodeInformation* nodeInfo = FindNodeInformation(NodeSignatureTable::Get().GetSignatureGuid(id), a_ContextGraph);
+		if (nodeInfo != nullptr && nodeInfo->AcceptsPinTypeInDirection(a_PinType, a_Direction))
+		{
+			a_OutCompatible.Add(id);
+		}
+	}
+}
+
+NodeSignatureTable::SignatureId GraphNodeInformationDatabase::GetNumIndexedSignatures() const
+{
+	return m_NumIndexedSignatures;
+}
+
+const TArray<NodeSignatureTable::SignatureId>* GraphNodeInformationDatabase::FindCompatibleSignatures(
+	PinTypeTable::PinTypeId a_PinType, EEdGraphPinDirection a_Direction) const
+{
+	const PinTypeIndex& index = a_Direction == EEdGraphPinDirection::EGPD_Input ? m_InputPinTypeIndex : m_OutputPinTypeIndex;
+	return index.Find(a_PinType);
+}
+
+bool GraphNodeInformationDatabase::MergeRecordedNodeInformation()
+{
+	TMap<FGuid, GraphNodeInformation> recordedNodeInformation;
+	{
+		FScopeLock lock(&m_RecordedNodeInformationLock);
+		Exchange(recordedNodeInformation, m_RecordedNodeInformation);
+	}
+
+	for (const auto& recordedEntry : recordedNodeInformation)
+	{
+		if (!m_GraphNodeInformation.Contains(recordedEntry.Key))
+		{
+			m_GraphNodeInformation.Add(recordedEntry.Key, recordedEntry.Value);
+		}
+	}
+	m_HasUnsavedChanges |= recordedNodeInformation.Num() > 0;
+	return recordedNodeInformation.Num() > 0;
+}
+
+const GraphNodeInformation* GraphNodeInformationDatabase::FindContextFreeNodeInformation(const FGuid& a_NodeSignatureGuid, 
+	UEdGraph* a_TargetGraph)
 {
 	const GraphNodeInformation* info = m_GraphNodeInformation.Find(a_NodeSignatureGuid);
 
-	if (info == nullptr && !m_HasBuiltDatabase)
+	if (info == nullptr)
 	{
-		FillDatabase();
-		info = m_GraphNodeInformation.Find(a_NodeSignatureGuid);
-		/*UK2Node* templateNode = FindTemplateNodeForNodeGuid(a_NodeSignatureGuid, a_TargetGraph);
-		if (templateNode != nullptr)
+		GraphNodeInformation nodeInfo;
+		if (BuildTemplateNodeInformation(a_NodeSignatureGuid, a_TargetGraph, nodeInfo))
 		{
-			GraphNodeInformation nodeInfo(*templateNode);
 			info = &(m_GraphNodeInformation.Add(a_NodeSignatureGuid, nodeInfo));
-		}*/
+			m_HasUnsavedChanges = true;
+		}
 	}
 
 	return info;
 }
+
+bool GraphNodeInformationDatabase::BuildTemplateNodeInformation(const FGuid& a_NodeSignatureGuid, UEdGraph* a_TargetGraph, 
+	GraphNodeInformation& a_OutNodeInfo)
+{
+	UBlueprintNodeSpawner* nodeSpawner = m_SpawnerIndex.FindSpawner(a_NodeSignatureGuid);
+	UK2Node* templateNode = (nodeSpawner != nullptr) ? Cast<UK2Node>(nodeSpawner->GetTemplateNode(a_TargetGraph)) : nullptr;
+	if (templateNode == nullptr)
+	{
+		return false;
+	}
+
+	if (templateNode->Pins.Num() == 0)
+	{
+		templateNode->AllocateDefaultPins();
+		UE_LOG(BILog, Warning, TEXT("Allocating default pins for node %s"), *templateNode->
+			GetNodeTitle(ENodeTitleType::MenuTitle).ToString());
+	}
+	a_OutNodeInfo = GraphNodeInformation(*templateNode);
+	return true;
+}
+
+void GraphNodeInformationDatabase::ResolveSignatures(UEdGraph* a_ContextGraph)
+{
+	//Signatures indexed before their information was available are indexed now, out of id order.
+	TArray<NodeSignatureTable::SignatureId> unresolvedSignatures;
+	Exchange(unresolvedSignatures, m_UnresolvedSignatures);
+	for (NodeSignatureTable::SignatureId id : unresolvedSignatures)
+	{
+		const GraphNodeInformation* nodeInfo = FindContextFreeNodeInformation(NodeSignatureTable::Get().GetSignatureGuid(id), a_ContextGraph);
+		if (nodeInfo != nullptr)
+		{
+			IndexSignature(id, *nodeInfo);
+		}
+		else
+		{
+			m_UnresolvedSignatures.Add(id);
+		}
+	}
+	m_ResolvedSpawnerRevision = m_SpawnerIndex.GetRevision();
+}
+
+void GraphNodeInformationDatabase::IndexSignature(NodeSignatureTable::SignatureId a_SignatureId, const GraphNodeInformation& a_NodeInfo)
+{
+	//New signatures get increasing ids and land at the end, so this only shifts elements for late resolved signatures.
+	if (a_NodeInfo.IsContextSpecific())
+	{
+		m_ContextSpecificSignatures.Insert(a_SignatureId, NodeSignatureTable::LowerBound(m_ContextSpecificSignatures, a_SignatureId));
+	}
+	for (PinTypeTable::PinTypeId pinType : a_NodeInfo.GetInputPinTypes())
+	{
+		TArray<NodeSignatureTable::SignatureId>& signatures = m_InputPinTypeIndex.FindOrAdd(pinType);
+		signatures.Insert(a_SignatureId, NodeSignatureTable::LowerBound(signatures, a_SignatureId));
+	}
+	for (PinTypeTable::PinTypeId pinType : a_NodeInfo.GetOutputPinTypes())
+	{
+		TArray<NodeSignatureTable::SignatureId>& signatures = m_OutputPinTypeIndex.FindOrAdd(pinType);
+		signatures.Insert(a_SignatureId, NodeSignatureTable::LowerBound(signatures, a_SignatureId));
+	}
+}
+
+void GraphNodeInformationDatabase::ResetCompatibilityIndex()
+{
+	m_InputPinTypeIndex.Empty();
+	m_OutputPinTypeIndex.Empty();
+	m_ContextSpecificSignatures.Reset();
+	m_UnresolvedSignatures.Reset();
+	m_NumIndexedSignatures = 0;
+}
@@ -1,19 +1,77 @@
 #pragma once
 
+#include "ContextNodeInformationCache.h"
 #include "GraphNodeInformation.h"
+#include "NodeSignatureTable.h"
+#include "NodeSpawnerIndex.h"
 
+/** Pin types of the nodes that appear in the suggestion database, keyed on signature guid.
+ * Information is recorded from the nodes that are learned from and cached on disk. Signatures that were never recorded are
+ * resolved through the template node of their spawner. Nodes whose pins depend on where they are placed additionally keep
+ * information per blueprint in a bounded cache. */
 class GraphNodeInformationDatabase
 {
 public:
 	GraphNodeInformationDatabase();
 	~GraphNodeInformationDatabase();
 
-	void FillDatabase();
-	void FlushDatabase();
-
+	/** Looks up a_NodeSignatureGuid, building its information from the spawner's template node for a_ContainingGraph if needed.
+	 * Context specific nodes are looked up for the blueprint of a_ContainingGraph. Game thread only, the result is only valid 
+	 * until the next call */
 	const GraphNodeInformation* FindNodeInformation(const FGuid& a_NodeSignatureGuid, UEdGraph* a_ContainingGraph);
+	/** Looks up a_NodeSignatureGuid without building anything, can be used from any thread while no update runs */
+	const GraphNodeInformation* FindNodeInformation(const FGuid& a_NodeSignatureGuid) const;
+
+	/** Records the nodes of a_Graph that have no information yet. Game thread only, may run while queries do;
+	 * the information is picked up by the next UpdateCompatibilityIndex */
+	void RecordNodeInformation(const UEdGraph& a_Graph);
+	bool HasUnsavedChanges() const;
+
+	/** Writes the recorded information, or reads it back. Must not run concurrently with queries */
+	void Serialize(FArchive& a_Archive);
+	bool LoadFromFile(const FString& a_FilePath);
+	bool SaveToFile(const FString& a_FilePath);
+
+	/** Adds the signatures interned since the last update to the compatibility index, resolving their information for
+	 * a_ContextGraph where needed. Game thread only and must not run concurrently with queries */
+	void UpdateCompatibilityIndex(UEdGraph* a_ContextGraph);
+	/** Signature ids below this value are covered by the compatibility index, newer ones have to be checked one by one */
+	NodeSignatureTable::SignatureId GetNumIndexedSignatures() const;
+	/** Sorted ids of all indexed signatures with a pin of type a_PinType in a_Direction, or nullptr if there are none */
+	const TArray<NodeSignatureTable::SignatureId>* FindCompatibleSignatures(PinTypeTable::PinTypeId a_PinType,
+		EEdGraphPinDirection a_Direction) const;
+	/** Collects the context specific signatures in a_SortedSignatures, whose entries in the compatibility index may not hold in 
+	 * a_ContextGraph, and the ones among them that accept a_PinType in a_Direction there. Game thread only */
+	void CheckContextSpecificSignatures(const TArray<NodeSignatureTable::SignatureId>& a_SortedSignatures, PinTypeTable::PinTypeId a_PinType,
+		EEdGraphPinDirection a_Direction, UEdGraph* a_ContextGraph, TArray<NodeSignatureTable::SignatureId>& a_OutContextSpecific,
+		TArray<NodeSignatureTable::SignatureId>& a_OutCompatible);
 
 private:
+	typedef TMap<PinTypeTable::PinTypeId, TArray<NodeSignatureTable::SignatureId>> PinTypeIndex;
+
+	/** Context independent information for a_NodeSignatureGuid, built from a template node if it was not recorded */
+	const GraphNodeInformation* FindContextFreeNodeInformation(const FGuid& a_NodeSignatureGuid, UEdGraph* a_TargetGraph);
+	bool BuildTemplateNodeInformation(const FGuid& a_NodeSignatureGuid, UEdGraph* a_TargetGraph, GraphNodeInformation& a_OutNodeInfo);
+	/** Moves recorded information into m_GraphNodeInformation. Returns whether any was added */
+	bool MergeRecordedNodeInformation();
+	/** Indexes the unresolved signatures that have information by now, or can be resolved through a spawner */
+	void ResolveSignatures(UEdGraph* a_ContextGraph);
+	void IndexSignature(NodeSignatureTable::SignatureId a_SignatureId, const GraphNodeInformation& a_NodeInfo);
+	void ResetCompatibilityIndex();
+
 	TMap<FGuid, GraphNodeInformation> m_GraphNodeInformation;
-	bool m_HasBuiltDatabase;
+	bool m_HasUnsavedChanges;
+	NodeSpawnerIndex m_SpawnerIndex;
+	/** Spawner index revision the unresolved signatures were last tried against */
+	uint32 m_ResolvedSpawnerRevision;
+	ContextNodeInformationCache m_ContextNodeInformation;
+
+	TMap<FGuid, GraphNodeInformation> m_RecordedNodeInformation;
+	mutable FCriticalSection m_RecordedNodeInformationLock;
+
+	PinTypeIndex m_InputPinTypeIndex;
+	PinTypeIndex m_OutputPinTypeIndex;
+	TArray<NodeSignatureTable::SignatureId> m_ContextSpecificSignatures;
+	NodeSignatureTable::SignatureId m_NumIndexedSignatures;
+	TArray<NodeSignatureTable::SignatureId> m_UnresolvedSignatures;
 };
@@ -0,0 +1,161 @@
+#include "BIPluginPrivatePCH.h"
+#include "NodeSignatureCache.h"
+
+namespace
+{
+	void LogSignatureCacheStats()
+	{
+		NodeSignatureCache::Get().LogStats();
+	}
+
+	FAutoConsoleCommand SignatureCacheStatsCommand(
+		TEXT("BIPlugin_SignatureCacheStats"),
+		TEXT("Logs the number of cached node signatures and how often a signature was found in the cache instead of being built"),
+		FConsoleCommandDelegate::CreateStatic(&LogSignatureCacheStats));
+}
+
+NodeSignatureCache& NodeSignatureCache::Get()
+{
+	static NodeSignatureCache instance;
+	return instance;
+}
+
+NodeSignatureCache::NodeSignatureCache()
+	: m_NumHits(0)
+	, m_NumMisses(0)
+	, m_NumInvalidations(0)
+{
+	m_ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &NodeSignatureCache::OnObjectModified);
+	m_ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(this, &NodeSignatureCache::OnObjectPropertyChanged);
+	m_PostUndoRedoHandle = FEditorDelegates::PostUndoRedo.AddRaw(this, &NodeSignatureCache::OnPostUndoRedo);
+	m_PreGarbageCollectHandle = FCoreUObjectDelegates::PreGarbageCollect.AddRaw(this, &NodeSignatureCache::OnPreGarbageCollect);
+}
+
+NodeSignatureCache::~NodeSignatureCache()
+{
+	FCoreUObjectDelegates::OnObjectModified.Remove(m_ObjectModifiedHandle);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(m_ObjectPropertyChangedHandle);
+	FEditorDelegates::PostUndoRedo.Remove(m_PostUndoRedoHandle);
+	FCoreUObjectDelegates::PreGarbageCollect.Remove(m_PreGarbageCollectHandle);
+}
+
+NodeSignatureTable::SignatureId NodeSignatureCache::FindOrAdd(const UK2Node& a_Node)
+{
+	CachedSignature& cached = FindOrAddEntry(a_Node);
+	if (cached.m_SignatureId == NodeSignatureTable::INVALID_SIGNATURE_ID)
+	{
+		//Interning needs the full signature and title, which are only built the first time a signature is seen.
+		cached.m_SignatureId = NodeSignatureTable::Get().FindOrAdd(a_Node);
+	}
+	return cached.m_SignatureId;
+}
+
+NodeSignatureTable::SignatureId NodeSignatureCache::Find(const UK2Node& a_Node)
+{
+	CachedSignature& cached = FindOrAddEntry(a_Node);
+	if (cached.m_SignatureId == NodeSignatureTable::INVALID_SIGNATURE_ID)
+	{
+		//The signature may have been interned through another node since.
+		cached.m_SignatureId = NodeSignatureTable::Get().Find(cached.m_SignatureGuid);
+	}
+	return cached.m_SignatureId;
+}
+
+FGuid NodeSignatureCache::GetSignatureGuid(const UK2Node& a_Node)
+{
+	return FindOrAddEntry(a_Node).m_SignatureGuid;
+}
+
+void NodeSignatureCache::Invalidate(const UK2Node& a_Node)
+{
+	if (m_Signatures.Remove(FWeakObjectPtr(&a_Node)) > 0)
+	{
+		++m_NumInvalidations;
+	}
+}
+
+void NodeSignatureCache::InvalidateBlueprint(const UBlueprint& a_Blueprint)
+{
+	TArray<UEdGraph*> graphs;
+	a_Blueprint.GetAllGraphs(graphs);
+	for (const UEdGraph* graph : graphs)
+	{
+		for (const UEdGraphNode* graphNode : graph->Nodes)
+		{
+			const UK2Node* node = Cast<UK2Node>(graphNode);
+			if (node != nullptr)
+			{
+				Invalidate(*node);
+			}
+		}
+	}
+}
+
+void NodeSignatureCache::Empty()
+{
+	m_Signatures.Empty();
+}
+
+void NodeSignatureCache::LogStats() const
+{
+	const uint64 numLookups = m_NumHits + m_NumMisses;
+	UE_LOG(BILog, Display, TEXT("Node signature cache: %i entries, %llu hits, %llu misses (%.1f%% hit rate), %llu invalidations"),
+		m_Signatures.Num(), m_NumHits, m_NumMisses, (numLookups > 0) ? 100.0 * m_NumHits / numLookups : 0.0, m_NumInvalidations);
+}
+
+NodeSignatureCache::CachedSignature& NodeSignatureCache::FindOrAddEntry(const UK2Node& a_Node)
+{
+	const FWeakObjectPtr nodeKey(&a_Node);
+	CachedSignature* cached = m_Signatures.Find(nodeKey);
+	if (cached != nullptr)
+	{
+		++m_NumHits;
+		return *cached;
+	}
+
+	++m_NumMisses;
+	CachedSignature& newEntry = m_Signatures.Add(nodeKey);
+	newEntry.m_SignatureGuid = a_Node.GetSignature().AsGuid();
+	newEntry.m_SignatureId = NodeSignatureTable::Get().Find(newEntry.m_SignatureGuid);
+	return newEntry;
+}
+
+void NodeSignatureCache::OnObjectModified(UObject* a_Object)
+{
+	//Signatures are built from the node's properties and pins, so editing either may change it.
+	const UK2Node* node = Cast<UK2Node>(a_Object);
+	const UEdGraphPin* pin = Cast<UEdGraphPin>(a_Object);
+	if (node == nullptr && pin != nullptr)
+	{
+		node = Cast<UK2Node>(pin->GetOwningNode());
+	}
+	if (node != nullptr)
+	{
+		Invalidate(*node);
+	}
+}
+
+void NodeSignatureCache::OnObjectPropertyChanged(UObject* a_Object, FPropertyChangedEvent& a_PropertyChangedEvent)
+{
+	//Modify() is called before the change, a signature built in between would be stale.
+	OnObjectModified(a_Object);
+}
+
+void NodeSignatureCache::OnPostUndoRedo()
+{
+	//Undo restores the state of nodes without modifying them, and which nodes a transaction touched is not known.
+	m_NumInvalidations += m_Signatures.Num();
+	Empty();
+}
+
+void NodeSignatureCache::OnPreGarbageCollect()
+{
+	//Entries of nodes destroyed by the previous collection can never be hit again.
+	for (auto it = m_Signatures.CreateIterator(); it; ++it)
+	{
+		if (!it.Key().IsValid())
+		{
+			it.RemoveCurrent();
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "NodeSignatureTable.h"
+
+/** Remembers the signature of graph nodes, as building a signature is expensive for nodes like function calls and variables.
+ * Entries are dropped when their node or one of its pins is modified or has a property changed, all entries after an undo or redo,
+ * and entries of destroyed nodes before garbage collection.
+ * Hit rates are logged by BIPlugin_SignatureCacheStats. Game thread only. */
+class NodeSignatureCache
+{
+public:
+	static NodeSignatureCache& Get();
+
+	NodeSignatureCache();
+	~NodeSignatureCache();
+
+	/** Interned id of the signature of a_Node, interning it if needed */
+	NodeSignatureTable::SignatureId FindOrAdd(const UK2Node& a_Node);
+	/** Interned id of the signature of a_Node, or INVALID_SIGNATURE_ID if it was never interned */
+	NodeSignatureTable::SignatureId Find(const UK2Node& a_Node);
+	FGuid GetSignatureGuid(const UK2Node& a_Node);
+
+	void Invalidate(const UK2Node& a_Node);
+	/** Drops the entries of every node in a_Blueprint, whose nodes may have been reconstructed without being modified */
+	void InvalidateBlueprint(const UBlueprint& a_Blueprint);
+	void Empty();
+	void LogStats() const;
+
+private:
+	struct CachedSignature
+	{
+		FGuid m_SignatureGuid;
+		NodeSignatureTable::SignatureId m_SignatureId; //INVALID_SIGNATURE_ID until the signature is interned
+	};
+
+	/** Entry for a_Node, building its signature on a miss. The result is only valid until the entries change */
+	CachedSignature& FindOrAddEntry(const UK2Node& a_Node);
+	void OnObjectModified(UObject* a_Object);
+	void OnObjectPropertyChanged(UObject* a_Object, FPropertyChangedEvent& a_PropertyChangedEvent);
+	void OnPostUndoRedo();
+	void OnPreGarbageCollect();
+
+	TMap<FWeakObjectPtr, CachedSignature> m_Signatures;
+	uint64 m_NumHits;
+	uint64 m_NumMisses;
+	uint64 m_NumInvalidations;
+
+	FDelegateHandle m_ObjectModifiedHandle;
+	FDelegateHandle m_ObjectPropertyChangedHandle;
+	FDelegateHandle m_PostUndoRedoHandle;
+	FDelegateHandle m_PreGarbageCollectHandle;
+};
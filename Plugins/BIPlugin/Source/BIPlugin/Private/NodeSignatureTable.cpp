@@ -0,0 +1,182 @@
+#include "BIPluginPrivatePCH.h"
+#include "NodeSignatureTable.h"
+
+NodeSignatureTable& NodeSignatureTable::Get()
+{
+	static NodeSignatureTable instance;
+	return instance;
+}
+
+int32 NodeSignatureTable::LowerBound(const TArray<SignatureId>& a_SortedIds, SignatureId a_Id, int32 a_First)
+{
+	int32 last = a_SortedIds.Num();
+	while (a_First < last)
+	{
+		const int32 middle = a_First + (last - a_First) / 2;
+		if (a_SortedIds[middle] < a_Id)
+		{
+			a_First = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	return a_First;
+}
+
+void NodeSignatureTable::IntersectSorted(const TArray<SignatureId>& a_First, const TArray<SignatureId>& a_Second, 
+	TArray<SignatureId>& a_Output)
+{
+	const TArray<SignatureId>& smaller = a_First.Num() <= a_Second.Num() ? a_First : a_Second;
+	const TArray<SignatureId>& larger = a_First.Num() <= a_Second.Num() ? a_Second : a_First;
+	int32 searchStart = 0;
+	for (SignatureId id : smaller)
+	{
+		searchStart = LowerBound(larger, id, searchStart);
+		if (searchStart == larger.Num())
+		{
+			break;
+		}
+		if (larger[searchStart] == id)
+		{
+			a_Output.Add(id);
+		}
+	}
+}
+
+NodeSignatureTable::NodeSignatureTable()
+{
+	//Id 0 is reserved so default constructed entries always resolve to something.
+	SignatureEntry& invalidEntry = m_Entries[m_Entries.AddDefaulted()];
+	invalidEntry.m_Signature = FBlueprintNodeSignature(TEXT("DEFAULT_INVALID_SIGNATURE"));
+}
+
+NodeSignatureTable::~NodeSignatureTable()
+{
+}
+
+NodeSignatureTable::SignatureId NodeSignatureTable::FindOrAdd(const UK2Node& a_Node)
+{
+	FBlueprintNodeSignature signature = a_Node.GetSignature();
+	const FGuid signatureGuid = signature.AsGuid();
+
+	const SignatureId existingId = Find(signatureGuid);
+	if (existingId != INVALID_SIGNATURE_ID)
+	{
+		return existingId;
+	}
+	return FindOrAdd(signatureGuid, signature, a_Node.GetNodeTitle(ENodeTitleType::MenuTitle));
+}
+
+NodeSignatureTable::SignatureId NodeSignatureTable::FindOrAdd(const FGuid& a_SignatureGuid, const FBlueprintNodeSignature& a_Signature, const FText& a_Title)
+{
+	FScopeLock lock(&m_Lock);
+	const SignatureId* existingId = m_GuidToId.Find(a_SignatureGuid);
+	if (existingId != nullptr)
+	{
+		return *existingId;
+	}
+
+	const SignatureId newId = static_cast<SignatureId>(m_Entries.AddDefaulted());
+	SignatureEntry& entry = m_Entries[newId];
+	entry.m_SignatureGuid = a_SignatureGuid;
+	entry.m_Signature = a_Signature;
+	entry.m_Title = a_Title;
+	m_GuidToId.Add(a_SignatureGuid, newId);
+	return newId;
+}
+
+NodeSignatureTable::SignatureId NodeSignatureTable::FindOrAddDeferred(const FGuid& a_SignatureGuid, const StringBufferRef& a_StringBuffer, 
+	int32 a_SignatureOffset, int32 a_TitleOffset)
+{
+	FScopeLock lock(&m_Lock);
+	const SignatureId* existingId = m_GuidToId.Find(a_SignatureGuid);
+	if (existingId != nullptr)
+	{
+		return *existingId;
+	}
+
+	const SignatureId newId = static_cast<SignatureId>(m_Entries.AddDefaulted());
+	SignatureEntry& entry = m_Entries[newId];
+	entry.m_SignatureGuid = a_SignatureGuid;
+	entry.m_DeferredStrings = a_StringBuffer;
+	entry.m_DeferredSignatureOffset = a_SignatureOffset;
+	entry.m_DeferredTitleOffset = a_TitleOffset;
+	m_GuidToId.Add(a_SignatureGuid, newId);
+	return newId;
+}
+
+NodeSignatureTable::SignatureId NodeSignatureTable::Find(const FGuid& a_SignatureGuid) const
+{
+	FScopeLock lock(&m_Lock);
+	const SignatureId* existingId = m_GuidToId.Find(a_SignatureGuid);
+	return (existingId != nullptr) ? *existingId : INVALID_SIGNATURE_ID;
+}
+
+FBlueprintNodeSignature NodeSignatureTable::GetSignature(SignatureId a_Id) const
+{
+	FScopeLock lock(&m_Lock);
+	return GetResolvedEntry(a_Id).m_Signature;
+}
+
+FGuid NodeSignatureTable::GetSignatureGuid(SignatureId a_Id) const
+{
+	FScopeLock lock(&m_Lock);
+	return m_Entries[a_Id].m_SignatureGuid;
+}
+
+FText NodeSignatureTable::GetTitle(SignatureId a_Id) const
+{
+	FScopeLock lock(&m_Lock);
+	return GetResolvedEntry(a_Id).m_Title;
+}
+
+int32 NodeSignatureTable::Num() const
+{
+	FScopeLock lock(&m_Lock);
+	return m_Entries.Num();
+}
+
+void NodeSignatureTable::Serialize(FArchive& a_Archive, TArray<SignatureId>& a_OutFileToTableIds)
+{
+	int32 numEntries = Num();
+	a_Archive << numEntries;
+
+	a_OutFileToTableIds.Empty(numEntries);
+	a_OutFileToTableIds.Add(INVALID_SIGNATURE_ID);
+	for (int32 i = 1; i < numEntries; ++i)
+	{
+		if (a_Archive.IsLoading())
+		{
+			FGuid signatureGuid;
+			FString signature;
+			FText title;
+			a_Archive << signatureGuid << signature << title;
+			a_OutFileToTableIds.Add(FindOrAdd(signatureGuid, FBlueprintNodeSignature(signature), title));
+		}
+		else
+		{
+			FScopeLock lock(&m_Lock);
+			const SignatureEntry& entry = GetResolvedEntry(static_cast<SignatureId>(i));
+			FString signature = entry.m_Signature.ToString();
+			FGuid signatureGuid = entry.m_SignatureGuid;
+			FText title = entry.m_Title;
+			a_Archive << signatureGuid << signature << title;
+			a_OutFileToTableIds.Add(static_cast<SignatureId>(i));
+		}
+	}
+}
+
+const NodeSignatureTable::SignatureEntry& NodeSignatureTable::GetResolvedEntry(SignatureId a_Id) const
+{
+	SignatureEntry& entry = m_Entries[a_Id];
+	if (entry.m_DeferredStrings.IsValid())
+	{
+		const ANSICHAR* strings = reinterpret_cast<const ANSICHAR*>(entry.m_DeferredStrings->GetData());
+		entry.m_Signature = FBlueprintNodeSignature(FString(UTF8_TO_TCHAR(strings + entry.m_DeferredSignatureOffset)));
+		entry.m_Title = FText::FromString(FString(UTF8_TO_TCHAR(strings + entry.m_DeferredTitleOffset)));
+		entry.m_DeferredStrings.Reset();
+	}
+	return entry;
+}
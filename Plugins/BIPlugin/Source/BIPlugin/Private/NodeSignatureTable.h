@@ -0,0 +1,57 @@
+#pragma once
+
+/** Interns node signatures to compact ids, so the prediction database only has to store and compare integers. 
+ * Thread safe; lookups return copies as the table may grow on another thread. */
+class NodeSignatureTable
+{
+public:
+	typedef uint32 SignatureId;
+	typedef TSharedRef<const TArray<uint8>, ESPMode::ThreadSafe> StringBufferRef;
+	static const SignatureId INVALID_SIGNATURE_ID = 0;
+
+	static NodeSignatureTable& Get();
+
+	/** Index of the first id in a_SortedIds at or after a_First that is not less than a_Id */
+	static int32 LowerBound(const TArray<SignatureId>& a_SortedIds, SignatureId a_Id, int32 a_First = 0);
+	/** Appends the ids in both sorted sets to a_Output. Walks the smaller set and binary searches the larger one, 
+	 * so the cost is bound by the smaller set instead of the sum of both */
+	static void IntersectSorted(const TArray<SignatureId>& a_First, const TArray<SignatureId>& a_Second, TArray<SignatureId>& a_Output);
+
+	NodeSignatureTable();
+	~NodeSignatureTable();
+
+	/** Builds the signature of a_Node, NodeSignatureCache avoids that for nodes that were seen before */
+	SignatureId FindOrAdd(const UK2Node& a_Node);
+	SignatureId FindOrAdd(const FGuid& a_SignatureGuid, const FBlueprintNodeSignature& a_Signature, const FText& a_Title);
+	/** Interns a signature whose signature string and title stay UTF-8 encoded in a_StringBuffer until they are first requested */
+	SignatureId FindOrAddDeferred(const FGuid& a_SignatureGuid, const StringBufferRef& a_StringBuffer, int32 a_SignatureOffset, int32 a_TitleOffset);
+	SignatureId Find(const FGuid& a_SignatureGuid) const;
+
+	FBlueprintNodeSignature GetSignature(SignatureId a_Id) const;
+	FGuid GetSignatureGuid(SignatureId a_Id) const;
+	FText GetTitle(SignatureId a_Id) const;
+	int32 Num() const;
+
+	/** Writes all interned signatures, or reads them back. a_OutFileToTableIds maps the ids stored in the archive to the ids in this table */
+	void Serialize(FArchive& a_Archive, TArray<SignatureId>& a_OutFileToTableIds);
+
+private:
+	struct SignatureEntry
+	{
+		FGuid m_SignatureGuid;
+		FBlueprintNodeSignature m_Signature;
+		FText m_Title;
+
+		TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> m_DeferredStrings;
+		int32 m_DeferredSignatureOffset;
+		int32 m_DeferredTitleOffset;
+	};
+
+	/** Decodes the deferred strings of an entry if needed. m_Lock has to be held */
+	const SignatureEntry& GetResolvedEntry(SignatureId a_Id) const;
+
+	mutable TArray<SignatureEntry> m_Entries; //Mutable so deferred entries can be resolved on first access
+
+	TMap<FGuid, SignatureId> m_GuidToId;
+	mutable FCriticalSection m_Lock;
+};
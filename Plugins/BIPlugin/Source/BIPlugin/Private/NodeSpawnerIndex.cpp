@@ -0,0 +1,126 @@
+#include "BIPluginPrivatePCH.h"
+#include "NodeSpawnerIndex.h"
+
+#include "BlueprintActionDatabase.h"
+#include "BlueprintNodeSpawner.h"
+
+NodeSpawnerIndex::OwnedSpawner::OwnedSpawner(const UObject* a_ActionKey, UBlueprintNodeSpawner* a_Spawner)
+	: m_ActionKey(a_ActionKey)
+	, m_Spawner(a_Spawner)
+{
+}
+
+NodeSpawnerIndex::NodeSpawnerIndex()
+	: m_HasBuiltIndex(false)
+	, m_Revision(0)
+{
+}
+
+NodeSpawnerIndex::~NodeSpawnerIndex()
+{
+	if (m_HasBuiltIndex)
+	{
+		FBlueprintActionDatabase& actionDatabase = FBlueprintActionDatabase::Get();
+		actionDatabase.OnEntryUpdated().Remove(m_EntryUpdatedHandle);
+		actionDatabase.OnEntryRemoved().Remove(m_EntryRemovedHandle);
+	}
+}
+
+UBlueprintNodeSpawner* NodeSpawnerIndex::FindSpawner(const FGuid& a_SignatureGuid)
+{
+	if (!m_HasBuiltIndex)
+	{
+		BuildIndex();
+	}
+
+	//The most recently added spawner wins, like it would when the whole action database was scanned.
+	const SpawnerList* spawners = m_Spawners.Find(a_SignatureGuid);
+	if (spawners != nullptr)
+	{
+		for (int32 i = spawners->Num() - 1; i >= 0; --i)
+		{
+			UBlueprintNodeSpawner* spawner = (*spawners)[i].m_Spawner.Get();
+			if (spawner != nullptr)
+			{
+				return spawner;
+			}
+		}
+	}
+	return nullptr;
+}
+
+uint32 NodeSpawnerIndex::GetRevision() const
+{
+	return m_Revision;
+}
+
+void NodeSpawnerIndex::BuildIndex()
+{
+	const uint32 startCycles = FPlatformTime::Cycles();
+	FBlueprintActionDatabase& actionDatabase = FBlueprintActionDatabase::Get();
+	for (auto const& actionEntry : actionDatabase.GetAllActions())
+	{
+		AddActions(actionEntry.Key.Get(), actionEntry.Value);
+	}
+
+	m_EntryUpdatedHandle = actionDatabase.OnEntryUpdated().AddRaw(this, &NodeSpawnerIndex::OnEntryUpdated);
+	m_EntryRemovedHandle = actionDatabase.OnEntryRemoved().AddRaw(this, &NodeSpawnerIndex::OnEntryRemoved);
+	m_HasBuiltIndex = true;
+
+	UE_LOG(BILog, Log, TEXT("Indexed %i node signatures of the action database in %.2f ms"), m_Spawners.Num(),
+		FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startCycles));
+}
+
+void NodeSpawnerIndex::AddActions(const UObject* a_ActionKey, const TArray<UBlueprintNodeSpawner*>& a_Spawners)
+{
+	TArray<FGuid>& actionSignatures = m_ActionKeySignatures.FindOrAdd(a_ActionKey);
+	for (UBlueprintNodeSpawner* nodeSpawner : a_Spawners)
+	{
+		//Templates are cached by the spawner, so they are only built the first time an action is indexed.
+		UEdGraphNode* nodeTemplate = nodeSpawner->GetTemplateNode();
+		UK2Node* ukNode = Cast<UK2Node>(nodeTemplate);
+		if (ukNode != nullptr)
+		{
+			const FGuid signatureGuid = ukNode->GetSignature().AsGuid();
+			m_Spawners.FindOrAdd(signatureGuid).Add(OwnedSpawner(a_ActionKey, nodeSpawner));
+			actionSignatures.Add(signatureGuid);
+		}
+	}
+	++m_Revision;
+}
+
+void NodeSpawnerIndex::RemoveActions(const UObject* a_ActionKey)
+{
+	TArray<FGuid> actionSignatures;
+	if (m_ActionKeySignatures.RemoveAndCopyValue(a_ActionKey, actionSignatures))
+	{
+		for (const FGuid& signatureGuid : actionSignatures)
+		{
+			//Spawners registered for the same signature by other action keys stay in the index.
+			SpawnerList* spawners = m_Spawners.Find(signatureGuid);
+			if (spawners != nullptr)
+			{
+				spawners->RemoveAll([a_ActionKey](const OwnedSpawner& a_Owned) { return a_Owned.m_ActionKey == a_ActionKey; });
+				if (spawners->Num() == 0)
+				{
+					m_Spawners.Remove(signatureGuid);
+				}
+			}
+		}
+	}
+}
+
+void NodeSpawnerIndex::OnEntryUpdated(UObject* a_ActionKey)
+{
+	RemoveActions(a_ActionKey);
+	const FBlueprintActionDatabase::FActionList* actions = FBlueprintActionDatabase::Get().GetAllActions().Find(a_ActionKey);
+	if (actions != nullptr)
+	{
+		AddActions(a_ActionKey, *actions);
+	}
+}
+
+void NodeSpawnerIndex::OnEntryRemoved(UObject* a_ActionKey)
+{
+	RemoveActions(a_ActionKey);
+}
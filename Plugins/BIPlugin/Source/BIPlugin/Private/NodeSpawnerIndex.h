@@ -0,0 +1,43 @@
+#pragma once
+
+class UBlueprintNodeSpawner;
+/** Maps node signature guids to the spawner of the action that creates such a node, so node information for a signature
+ * can be built from a single template node instead of scanning the whole action database.
+ * Built on first use and kept current through the action database's update notifications. Game thread only. */
+class NodeSpawnerIndex
+{
+public:
+	NodeSpawnerIndex();
+	~NodeSpawnerIndex();
+
+	/** Spawner whose template node has signature a_SignatureGuid, or nullptr if there is none */
+	UBlueprintNodeSpawner* FindSpawner(const FGuid& a_SignatureGuid);
+	/** Changes whenever spawners were added to the index, lookups that failed before may succeed afterwards */
+	uint32 GetRevision() const;
+
+private:
+	void BuildIndex();
+	void AddActions(const UObject* a_ActionKey, const TArray<UBlueprintNodeSpawner*>& a_Spawners);
+	void RemoveActions(const UObject* a_ActionKey);
+	void OnEntryUpdated(UObject* a_ActionKey);
+	void OnEntryRemoved(UObject* a_ActionKey);
+
+	struct OwnedSpawner
+	{
+		OwnedSpawner(const UObject* a_ActionKey, UBlueprintNodeSpawner* a_Spawner);
+
+		//Action keys are only compared, they may already be in the middle of being destroyed when they are removed.
+		const UObject* m_ActionKey;
+		TWeakObjectPtr<UBlueprintNodeSpawner> m_Spawner;
+	};
+	/** Every action key can register the same signature, so a signature stays indexed until all of them are removed */
+	typedef TArray<OwnedSpawner, TInlineAllocator<1>> SpawnerList;
+
+	TMap<FGuid, SpawnerList> m_Spawners;
+	TMap<const UObject*, TArray<FGuid>> m_ActionKeySignatures;
+	bool m_HasBuiltIndex;
+	uint32 m_Revision;
+
+	FDelegateHandle m_EntryUpdatedHandle;
+	FDelegateHandle m_EntryRemovedHandle;
+};
@@ -4,7 +4,6 @@
 PathContextPath::PathContextPath()
 	: m_ContextPath()
 {
-	m_ContextPath.Reserve(MAX_CONTEXT_PATH_LENGTH);
 }
 
 PathContextPath::PathContextPath(const PathContextPath& a_Other)
@@ -21,6 +20,11 @@ bool PathContextPath::operator ==(const PathContextPath& a_Other) const
 	return m_ContextPath == a_Other.m_ContextPath;
 }
 
+uint32 GetTypeHash(const PathContextPath& a_Instance)
+{
+	return FCrc::MemCrc32(a_Instance.m_ContextPath.GetData(), a_Instance.m_ContextPath.Num() * sizeof(PathNodeEntry));
+}
+
 FArchive& operator << (FArchive& a_Archive, PathContextPath& a_Value)
 {
 	return a_Archive << a_Value.m_ContextPath;
@@ -31,6 +35,27 @@ void PathContextPath::PushNode(const PathNodeEntry& a_Node)
 	m_ContextPath.Push(a_Node);
 }
 
+void PathContextPath::Reset(int32 a_Length)
+{
+	m_ContextPath.Reset();
+	m_ContextPath.AddUninitialized(a_Length);
+}
+
+void PathContextPath::SetNode(int32 a_Index, const PathNodeEntry& a_Node)
+{
+	m_ContextPath[a_Index] = a_Node;
+}
+
+int32 PathContextPath::Num() const
+{
+	return m_ContextPath.Num();
+}
+
+const PathNodeEntry& PathContextPath::GetNode(int32 a_Index) const
+{
+	return m_ContextPath[a_Index];
+}
+
 float PathContextPath::CompareContext(const PathContextPath& a_Other) const
 {
 	int32 matchingNodes = 0;
@@ -55,10 +80,18 @@ float PathContextPath::CompareContext(const PathContextPath& a_Other) const
 FString PathContextPath::GetPathString() const
 {
 	FString path;
-	for (PathNodeEntry nodeEntry : m_ContextPath)
+	for (const PathNodeEntry& nodeEntry : m_ContextPath)
 	{
-		path.Append(nodeEntry.m_NodeTitle.ToString());
+		path.Append(nodeEntry.GetTitle().ToString());
 		path.Append(" >> ");
 	}
 	return path;
 }
+
+void PathContextPath::RemapSignatureIds(const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds)
+{
+	for (PathNodeEntry& nodeEntry : m_ContextPath)
+	{
+		nodeEntry.m_SignatureId = a_FileToTableIds[nodeEntry.m_SignatureId];
+	}
+}
@@ -13,11 +13,18 @@ public:
 	~PathContextPath();
 
 	bool operator == (const PathContextPath& a_Other) const;
+	friend uint32 GetTypeHash(const PathContextPath& a_Instance);
 	friend FArchive& operator << (FArchive& a_Archive, PathContextPath& a_Value);
 
 	void PushNode(const PathNodeEntry& a_Node);
+	/** Resizes the path to a_Length nodes, which have to be set with SetNode. Keeps the memory */
+	void Reset(int32 a_Length);
+	void SetNode(int32 a_Index, const PathNodeEntry& a_Node);
+	int32 Num() const;
+	const PathNodeEntry& GetNode(int32 a_Index) const;
 	float CompareContext(const PathContextPath& a_Other) const;
 	FString GetPathString() const;
+	void RemapSignatureIds(const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds);
 private:
-	TArray<PathNodeEntry> m_ContextPath;
+	TArray<PathNodeEntry, TInlineAllocator<MAX_CONTEXT_PATH_LENGTH>> m_ContextPath;
 };
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "BIPluginPrivatePCH.h"
+#include "PathContextTrie.h"
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarContextPathLength(
+		TEXT("BIPlugin.ContextPathLength"),
+		static_cast<int32>(PathContextPath::MAX_CONTEXT_PATH_LENGTH),
+		TEXT("Number of nodes in front of the anchor that are compared to find suggestions for the same context, at most 3. ")
+		TEXT("Shorter paths make learning and queries faster on densely linked graphs"),
+		ECVF_Default);
+
+	TAutoConsoleVariable<int32> CVarPathBudget(
+		TEXT("BIPlugin.PathBudget"),
+		static_cast<int32>(PathContextTrie::DEFAULT_PATH_BUDGET),
+		TEXT("Maximum number of paths followed from a single node when learning or querying, 0 for no limit. ")
+		TEXT("Links of the nodes with the most neighbours are cut first, see BIPlugin_PathWalkStats for how many were cut"),
+		ECVF_Default);
+}
+
+PathContextTrie::WalkStats::WalkStats()
+	: m_NumWalks(0)
+	, m_NumPaths(0)
+	, m_NumPrunedPaths(0)
+{
+}
+
+void PathContextTrie::WalkStats::Add(const WalkStats& a_Other)
+{
+	m_NumWalks += a_Other.m_NumWalks;
+	m_NumPaths += a_Other.m_NumPaths;
+	m_NumPrunedPaths += a_Other.m_NumPrunedPaths;
+}
+
+int32 PathContextTrie::GetConfiguredContextLength()
+{
+	return FMath::Clamp(CVarContextPathLength.GetValueOnGameThread(), 0, static_cast<int32>(PathContextPath::MAX_CONTEXT_PATH_LENGTH));
+}
+
+int32 PathContextTrie::GetConfiguredPathBudget()
+{
+	return FMath::Max(CVarPathBudget.GetValueOnGameThread(), 0);
+}
+
+PathContextTrie::PathContextTrie()
+{
+	Reset();
+}
+
+PathContextTrie::~PathContextTrie()
+{
+}
+
+void PathContextTrie::Reset()
+{
+	m_Nodes.Reset();
+	TrieNode& root = m_Nodes[m_Nodes.AddUninitialized()];
+	root.m_SignatureId = INDEX_NONE;
+	root.m_Parent = INDEX_NONE;
+	root.m_Length = 0;
+	root.m_HasChildren = false;
+}
+
+PathContextTrie::PathIndex PathContextTrie::AddNode(PathIndex a_Parent, NodeSignatureTable::SignatureId a_SignatureId)
+{
+	const PathIndex path = m_Nodes.AddUninitialized();
+	TrieNode& parent = m_Nodes[a_Parent];
+	parent.m_HasChildren = true;
+
+	TrieNode& node = m_Nodes[path];
+	node.m_SignatureId = a_SignatureId;
+	node.m_Parent = a_Parent;
+	node.m_Length = parent.m_Length + 1;
+	node.m_HasChildren = false;
+	return path;
+}
+
+int32 PathContextTrie::Num() const
+{
+	return m_Nodes.Num();
+}
+
+int32 PathContextTrie::GetLength(PathIndex a_Path) const
+{
+	return m_Nodes[a_Path].m_Length;
+}
+
+NodeSignatureTable::SignatureId PathContextTrie::GetLastSignatureId(PathIndex a_Path) const
+{
+	return m_Nodes[a_Path].m_SignatureId;
+}
+
+bool PathContextTrie::IsLeaf(PathIndex a_Path) const
+{
+	return !m_Nodes[a_Path].m_HasChildren;
+}
+
+PathContextTrie::PathIndex PathContextTrie::GetPrefix(PathIndex a_Path, int32 a_Length) const
+{
+	PathIndex prefix = a_Path;
+	while (m_Nodes[prefix].m_Length > a_Length)
+	{
+		prefix = m_Nodes[prefix].m_Parent;
+	}
+	return prefix;
+}
+
+void PathContextTrie::GetPath(PathIndex a_Path, int32 a_FirstNode, PathContextPath& a_OutPath) const
+{
+	//Nodes only know their parent, so the path is filled back to front.
+	a_OutPath.Reset(FMath::Max(m_Nodes[a_Path].m_Length - a_FirstNode, 0));
+	for (PathIndex path = a_Path; m_Nodes[path].m_Length > a_FirstNode; path = m_Nodes[path].m_Parent)
+	{
+		a_OutPath.SetNode(m_Nodes[path].m_Length - a_FirstNode - 1, PathNodeEntry(m_Nodes[path].m_SignatureId));
+	}
+}
+
+const PathContextTrie::WalkStats& PathContextTrie::GetStats() const
+{
+	return m_Stats;
+}
+
+int32 PathContextTrie::FindFanOutLimit(const int32* a_FanOuts, int32 a_NumFanOuts, int32 a_Budget, int32& a_OutNumExtraLinks)
+{
+	int32 maxFanOut = 0;
+	for (int32 i = 0; i < a_NumFanOuts; ++i)
+	{
+		maxFanOut = FMath::Max(maxFanOut, a_FanOuts[i]);
+	}
+
+	//Binary search for the largest limit whose links fit, a limit of 0 always does.
+	int32 fittingLimit = 0;
+	int32 fittingLinks = 0;
+	int32 exceedingLimit = maxFanOut + 1;
+	while (exceedingLimit - fittingLimit > 1)
+	{
+		const int32 limit = fittingLimit + (exceedingLimit - fittingLimit) / 2;
+		int32 numLinks = 0;
+		for (int32 i = 0; i < a_NumFanOuts; ++i)
+		{
+			numLinks += FMath::Min(a_FanOuts[i], limit);
+		}
+
+		if (numLinks <= a_Budget)
+		{
+			fittingLimit = limit;
+			fittingLinks = numLinks;
+		}
+		else
+		{
+			exceedingLimit = limit;
+		}
+	}
+
+	a_OutNumExtraLinks = a_Budget - fittingLinks;
+	return fittingLimit;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "PathContextPath.h"
+
+/** Paths found by walking a graph from one start node, stored as a tree so prefixes shared by several paths are stored once.
+ * A path is identified by the index of its last node, the empty path at the start node is ROOT_PATH. Paths are added one length
+ * at a time, so parents always have a lower index than their children. Reset keeps the memory, so a reused trie does not allocate
+ * as long as walks stay within DEFAULT_PATH_BUDGET. */
+class PathContextTrie
+{
+public:
+	typedef int32 PathIndex;
+	static const PathIndex ROOT_PATH = 0;
+	static const int32 DEFAULT_PATH_BUDGET = 512;
+
+	/** Totals over all walks of a trie, Reset keeps them */
+	struct WalkStats
+	{
+		WalkStats();
+		void Add(const WalkStats& a_Other);
+
+		uint64 m_NumWalks;
+		uint64 m_NumPaths;
+		uint64 m_NumPrunedPaths; //Links that were not followed because the walk ran out of budget
+	};
+
+	/** Context length set by BIPlugin.ContextPathLength, at most PathContextPath::MAX_CONTEXT_PATH_LENGTH. Game thread only */
+	static int32 GetConfiguredContextLength();
+	/** Paths per walk set by BIPlugin.PathBudget, 0 if walks are not bounded. Game thread only */
+	static int32 GetConfiguredPathBudget();
+
+	PathContextTrie();
+	~PathContextTrie();
+
+	void Reset();
+	PathIndex AddNode(PathIndex a_Parent, NodeSignatureTable::SignatureId a_SignatureId);
+
+	/** Number of paths including ROOT_PATH */
+	int32 Num() const;
+	int32 GetLength(PathIndex a_Path) const;
+	NodeSignatureTable::SignatureId GetLastSignatureId(PathIndex a_Path) const;
+	/** A path is a leaf if no longer path continues it */
+	bool IsLeaf(PathIndex a_Path) const;
+	/** The first a_Length nodes of a_Path */
+	PathIndex GetPrefix(PathIndex a_Path, int32 a_Length) const;
+	/** Writes the nodes of a_Path from a_FirstNode on into a_OutPath */
+	void GetPath(PathIndex a_Path, int32 a_FirstNode, PathContextPath& a_OutPath) const;
+	const WalkStats& GetStats() const;
+
+	/** Adds the paths of up to a_MaxLength nodes that leave a_Start below ROOT_PATH, which has to be the only path. 
+	 * With a_MaxPaths above 0 at most that many paths are added; once a length would exceed it, the links of the nodes with the
+	 * most neighbours are cut first, in link order, so the result is deterministic. Nothing is copied or allocated per visited node.
+	 * PATH_SOURCE provides NodeType, CountNeighbours(node), a NeighbourCursor that is started with GetFirstNeighbour(node) and 
+	 * advanced with GetNextNeighbour(cursor, outNode), and GetSignatureId(node) */
+	template <typename PATH_SOURCE>
+	void AddPaths(const PATH_SOURCE& a_Source, typename PATH_SOURCE::NodeType a_Start, int32 a_MaxLength, int32 a_MaxPaths);
+
+private:
+	struct TrieNode
+	{
+		NodeSignatureTable::SignatureId m_SignatureId;
+		PathIndex m_Parent;
+		int32 m_Length;
+		bool m_HasChildren;
+	};
+
+	/** Largest number of links per node that keeps the sum of a_FanOuts within a_Budget. a_OutNumExtraLinks nodes with more 
+	 * links than that can follow one link more, which uses up the budget exactly */
+	static int32 FindFanOutLimit(const int32* a_FanOuts, int32 a_NumFanOuts, int32 a_Budget, int32& a_OutNumExtraLinks);
+
+	TArray<TrieNode> m_Nodes;
+	WalkStats m_Stats;
+};
+
+template <typename PATH_SOURCE>
+void PathContextTrie::AddPaths(const PATH_SOURCE& a_Source, typename PATH_SOURCE::NodeType a_Start, int32 a_MaxLength, int32 a_MaxPaths)
+{
+	check(m_Nodes.Num() == 1);
+	++m_Stats.m_NumWalks;
+
+	//The graph node every path ends at is kept at the index of the path.
+	TArray<typename PATH_SOURCE::NodeType, TInlineAllocator<DEFAULT_PATH_BUDGET + 1>> pathEnds;
+	TArray<int32, TInlineAllocator<DEFAULT_PATH_BUDGET + 1>> fanOuts;
+	pathEnds.Add(a_Start);
+
+	PathIndex lengthStart = ROOT_PATH;
+	for (int32 length = 0; length < a_MaxLength && lengthStart < m_Nodes.Num(); ++length)
+	{
+		const PathIndex lengthEnd = m_Nodes.Num();
+		fanOuts.Reset();
+		int32 numLinks = 0;
+		for (PathIndex path = lengthStart; path < lengthEnd; ++path)
+		{
+			const int32 fanOut = a_Source.CountNeighbours(pathEnds[path]);
+			fanOuts.Add(fanOut);
+			numLinks += fanOut;
+		}
+
+		const int32 budget = (a_MaxPaths > 0) ? FMath::Max(a_MaxPaths - (m_Nodes.Num() - 1), 0) : numLinks;
+		int32 fanOutLimit = MAX_int32;
+		int32 numExtraLinks = 0;
+		if (numLinks > budget)
+		{
+			fanOutLimit = FindFanOutLimit(fanOuts.GetData(), fanOuts.Num(), budget, numExtraLinks);
+			m_Stats.m_NumPrunedPaths += numLinks - budget;
+		}
+
+		for (PathIndex path = lengthStart; path < lengthEnd; ++path)
+		{
+			const int32 fanOut = fanOuts[path - lengthStart];
+			int32 numChildren = FMath::Min(fanOut, fanOutLimit);
+			if (numChildren < fanOut && numExtraLinks > 0)
+			{
+				++numChildren;
+				--numExtraLinks;
+			}
+
+			typename PATH_SOURCE::NeighbourCursor cursor = a_Source.GetFirstNeighbour(pathEnds[path]);
+			typename PATH_SOURCE::NodeType neighbour;
+			for (int32 i = 0; i < numChildren && a_Source.GetNextNeighbour(cursor, neighbour); ++i)
+			{
+				AddNode(path, a_Source.GetSignatureId(neighbour));
+				pathEnds.Add(neighbour);
+			}
+		}
+		lengthStart = lengthEnd;
+	}
+	m_Stats.m_NumPaths += m_Nodes.Num() - 1;
+}
@@ -0,0 +1,399 @@
+#include "BIPluginPrivatePCH.h"
+#include "PathDatabaseFlatFile.h"
+
+namespace
+{
+	const int32 FLAT_FILE_HEADER_SIZE = 7 * sizeof(uint32);
+	const int32 FLAT_FILE_SIGNATURE_RECORD_SIZE = 6 * sizeof(uint32);
+	const int32 FLAT_FILE_ANCHOR_RECORD_SIZE = 3 * sizeof(uint32);
+	const int32 FLAT_FILE_ENTRY_HEADER_SIZE = 3 * sizeof(uint32);
+	const int32 FLAT_FILE_MAX_CONTEXT_SLOTS = 64;
+
+	uint32 AppendFlatFileString(TArray<uint8>& a_StringTable, const FString& a_String)
+	{
+		const uint32 offset = a_StringTable.Num();
+		FTCHARToUTF8 utf8String(*a_String);
+		a_StringTable.Append(reinterpret_cast<const uint8*>(utf8String.Get()), utf8String.Length());
+		a_StringTable.Add(0);
+		return offset;
+	}
+}
+
+TSharedPtr<PathDatabaseFlatFile> PathDatabaseFlatFile::Load(TArray<uint8>& a_FileData)
+{
+	TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> data = MakeShareable(new TArray<uint8>());
+	Exchange(*data, a_FileData);
+
+	TSharedPtr<PathDatabaseFlatFile> result = MakeShareable(new PathDatabaseFlatFile(data));
+	if (!result->ParseHeader())
+	{
+		result.Reset();
+	}
+	return result;
+}
+
+void PathDatabaseFlatFile::Write(FArchive& a_Archive, const PredictionDatabase& a_ForwardDatabase, const PredictionDatabase& a_BackwardDatabase,
+	const PathDatabaseFlatFile* a_PendingAnchors)
+{
+	//Table ids are written as file ids, so the entries can be written without translation.
+	const NodeSignatureTable& signatureTable = NodeSignatureTable::Get();
+	int32 numSignatures = signatureTable.Num() - 1;
+
+	TArray<uint8> stringTable;
+	TArray<uint32> stringOffsets;
+	stringOffsets.Reserve(numSignatures * 2);
+	for (int32 i = 1; i <= numSignatures; ++i)
+	{
+		const NodeSignatureTable::SignatureId id = static_cast<NodeSignatureTable::SignatureId>(i);
+		stringOffsets.Add(AppendFlatFileString(stringTable, signatureTable.GetSignature(id).ToString()));
+		stringOffsets.Add(AppendFlatFileString(stringTable, signatureTable.GetTitle(id).ToString()));
+	}
+
+	//Anchors are only in the database once they were decoded from the pending file, so the two never overlap.
+	const EPathDirection directions[] = { EPathDirection::Forward, EPathDirection::Backward };
+	const PredictionDatabase* databases[] = { &a_ForwardDatabase, &a_BackwardDatabase };
+	TArray<WrittenAnchor> sortedAnchors[2];
+	int32 numEntries[2] = { 0, 0 };
+	for (int32 direction = 0; direction < 2; ++direction)
+	{
+		for (const auto& anchorEntry : *databases[direction])
+		{
+			WrittenAnchor& anchor = sortedAnchors[direction][sortedAnchors[direction].AddUninitialized()];
+			anchor.m_AnchorId = anchorEntry.Key;
+			anchor.m_Predictions = &anchorEntry.Value;
+			anchor.m_PendingRecord = INDEX_NONE;
+			anchor.m_NumEntries = anchorEntry.Value.Num();
+		}
+		if (a_PendingAnchors != nullptr)
+		{
+			a_PendingAnchors->GetPendingAnchors(directions[direction], sortedAnchors[direction]);
+		}
+		sortedAnchors[direction].Sort();
+		for (const WrittenAnchor& anchor : sortedAnchors[direction])
+		{
+			numEntries[direction] += anchor.m_NumEntries;
+		}
+	}
+
+	int32 stringTableSize = stringTable.Num();
+	int32 contextSlots = PathContextPath::MAX_CONTEXT_PATH_LENGTH;
+	int32 numForwardAnchors = sortedAnchors[0].Num();
+	int32 numBackwardAnchors = sortedAnchors[1].Num();
+	a_Archive << numSignatures << stringTableSize << contextSlots << numForwardAnchors << numBackwardAnchors 
+		<< numEntries[0] << numEntries[1];
+
+	for (int32 i = 1; i <= numSignatures; ++i)
+	{
+		FGuid signatureGuid = signatureTable.GetSignatureGuid(static_cast<NodeSignatureTable::SignatureId>(i));
+		a_Archive << signatureGuid.A << signatureGuid.B << signatureGuid.C << signatureGuid.D;
+		a_Archive << stringOffsets[(i - 1) * 2] << stringOffsets[(i - 1) * 2 + 1];
+	}
+	a_Archive.Serialize(stringTable.GetData(), stringTable.Num());
+
+	for (int32 direction = 0; direction < 2; ++direction)
+	{
+		uint32 firstEntry = 0;
+		for (const WrittenAnchor& anchor : sortedAnchors[direction])
+		{
+			uint32 anchorId = anchor.m_AnchorId;
+			uint32 numAnchorEntries = anchor.m_NumEntries;
+			a_Archive << anchorId << firstEntry << numAnchorEntries;
+			firstEntry += numAnchorEntries;
+		}
+
+		for (const WrittenAnchor& anchor : sortedAnchors[direction])
+		{
+			if (anchor.m_Predictions == nullptr)
+			{
+				a_PendingAnchors->WritePendingEntries(a_Archive, directions[direction], anchor, contextSlots);
+				continue;
+			}
+
+			for (const PathPredictionEntry& entry : anchor.m_Predictions->GetEntries())
+			{
+				uint32 predictionId = entry.m_PredictionVertex.m_SignatureId;
+				int32 numUses = entry.m_NumUses;
+				uint32 contextLength = entry.m_ContextPath.Num();
+				a_Archive << predictionId << numUses << contextLength;
+				for (int32 i = 0; i < contextSlots; ++i)
+				{
+					uint32 contextId = (i < entry.m_ContextPath.Num()) ? entry.m_ContextPath.GetNode(i).m_SignatureId : 
+						NodeSignatureTable::INVALID_SIGNATURE_ID;
+					a_Archive << contextId;
+				}
+			}
+		}
+	}
+}
+
+PathDatabaseFlatFile::PathDatabaseFlatFile(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& a_Data)
+	: m_Data(a_Data)
+	, m_ContextSlots(0)
+	, m_EntryStride(0)
+	, m_NumPendingAnchors(0)
+{
+}
+
+PathDatabaseFlatFile::~PathDatabaseFlatFile()
+{
+}
+
+TSharedRef<PathDatabaseFlatFile> PathDatabaseFlatFile::CopyPendingAnchors() const
+{
+	return MakeShareable(new PathDatabaseFlatFile(*this));
+}
+
+int32 PathDatabaseFlatFile::NumPendingAnchors() const
+{
+	return m_NumPendingAnchors;
+}
+
+const TArray<NodeSignatureTable::SignatureId>& PathDatabaseFlatFile::GetFileToTableIds() const
+{
+	return m_FileToTableIds;
+}
+
+bool PathDatabaseFlatFile::LoadAnchor(EPathDirection a_Direction, NodeSignatureTable::SignatureId a_AnchorId, PredictionDatabase& a_Database)
+{
+	if (a_AnchorId >= static_cast<uint32>(m_TableToFileIds.Num()) || m_TableToFileIds[a_AnchorId] == 0)
+	{
+		return false;
+	}
+
+	DirectionSection& section = GetSection(a_Direction);
+	const int32 anchorRecord = FindAnchorRecord(section, m_TableToFileIds[a_AnchorId]);
+	if (anchorRecord == INDEX_NONE || section.m_LoadedAnchors[anchorRecord])
+	{
+		return false;
+	}
+
+	LoadAnchorRecord(a_Direction, anchorRecord, a_Database);
+	return true;
+}
+
+void PathDatabaseFlatFile::LoadAllAnchors(PredictionDatabase& a_ForwardDatabase, PredictionDatabase& a_BackwardDatabase)
+{
+	for (int32 anchorRecord = 0; anchorRecord < m_ForwardSection.m_NumAnchors; ++anchorRecord)
+	{
+		if (!m_ForwardSection.m_LoadedAnchors[anchorRecord])
+		{
+			LoadAnchorRecord(EPathDirection::Forward, anchorRecord, a_ForwardDatabase);
+		}
+	}
+	for (int32 anchorRecord = 0; anchorRecord < m_BackwardSection.m_NumAnchors; ++anchorRecord)
+	{
+		if (!m_BackwardSection.m_LoadedAnchors[anchorRecord])
+		{
+			LoadAnchorRecord(EPathDirection::Backward, anchorRecord, a_BackwardDatabase);
+		}
+	}
+}
+
+bool PathDatabaseFlatFile::ParseHeader()
+{
+	if (m_Data->Num() < FLAT_FILE_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	const int32 numSignatures = static_cast<int32>(ReadUInt32(0));
+	const int32 stringTableSize = static_cast<int32>(ReadUInt32(4));
+	m_ContextSlots = static_cast<int32>(ReadUInt32(8));
+	m_ForwardSection.m_NumAnchors = static_cast<int32>(ReadUInt32(12));
+	m_BackwardSection.m_NumAnchors = static_cast<int32>(ReadUInt32(16));
+	m_ForwardSection.m_NumEntries = static_cast<int32>(ReadUInt32(20));
+	m_BackwardSection.m_NumEntries = static_cast<int32>(ReadUInt32(24));
+	if (numSignatures < 0 || stringTableSize < 0 || m_ContextSlots < 0 || m_ContextSlots > FLAT_FILE_MAX_CONTEXT_SLOTS ||
+		m_ForwardSection.m_NumAnchors < 0 || m_BackwardSection.m_NumAnchors < 0 || 
+		m_ForwardSection.m_NumEntries < 0 || m_BackwardSection.m_NumEntries < 0)
+	{
+		return false;
+	}
+	m_EntryStride = FLAT_FILE_ENTRY_HEADER_SIZE + m_ContextSlots * sizeof(uint32);
+
+	//Sizes are validated up front, so the sections can be read without further bounds checks.
+	const int64 signaturesOffset = FLAT_FILE_HEADER_SIZE;
+	const int64 stringTableOffset = signaturesOffset + static_cast<int64>(numSignatures) * FLAT_FILE_SIGNATURE_RECORD_SIZE;
+	int64 sectionOffset = stringTableOffset + stringTableSize;
+	DirectionSection* sections[] = { &m_ForwardSection, &m_BackwardSection };
+	for (DirectionSection* section : sections)
+	{
+		const int64 anchorsOffset = sectionOffset;
+		const int64 entriesOffset = anchorsOffset + static_cast<int64>(section->m_NumAnchors) * FLAT_FILE_ANCHOR_RECORD_SIZE;
+		sectionOffset = entriesOffset + static_cast<int64>(section->m_NumEntries) * m_EntryStride;
+		if (sectionOffset > m_Data->Num())
+		{
+			return false;
+		}
+		section->m_AnchorsOffset = static_cast<int32>(anchorsOffset);
+		section->m_EntriesOffset = static_cast<int32>(entriesOffset);
+		section->m_LoadedAnchors.Init(false, section->m_NumAnchors);
+		m_NumPendingAnchors += section->m_NumAnchors;
+	}
+	if (sectionOffset != m_Data->Num() || (stringTableSize > 0 && (*m_Data)[stringTableOffset + stringTableSize - 1] != 0))
+	{
+		return false;
+	}
+
+	NodeSignatureTable& signatureTable = NodeSignatureTable::Get();
+	m_FileToTableIds.Reserve(numSignatures + 1);
+	m_FileToTableIds.Add(NodeSignatureTable::INVALID_SIGNATURE_ID);
+	NodeSignatureTable::SignatureId maxTableId = NodeSignatureTable::INVALID_SIGNATURE_ID;
+	for (int32 i = 0; i < numSignatures; ++i)
+	{
+		const int32 recordOffset = static_cast<int32>(signaturesOffset) + i * FLAT_FILE_SIGNATURE_RECORD_SIZE;
+		const FGuid signatureGuid(ReadUInt32(recordOffset), ReadUInt32(recordOffset + 4), ReadUInt32(recordOffset + 8), 
+			ReadUInt32(recordOffset + 12));
+		const uint32 signatureOffset = ReadUInt32(recordOffset + 16);
+		const uint32 titleOffset = ReadUInt32(recordOffset + 20);
+		if (signatureOffset >= static_cast<uint32>(stringTableSize) || titleOffset >= static_cast<uint32>(stringTableSize))
+		{
+			return false;
+		}
+
+		const NodeSignatureTable::SignatureId tableId = signatureTable.FindOrAddDeferred(signatureGuid, m_Data, 
+			static_cast<int32>(stringTableOffset) + signatureOffset, static_cast<int32>(stringTableOffset) + titleOffset);
+		m_FileToTableIds.Add(tableId);
+		maxTableId = FMath::Max(maxTableId, tableId);
+	}
+
+	m_TableToFileIds.AddZeroed(maxTableId + 1);
+	for (int32 fileId = 1; fileId < m_FileToTableIds.Num(); ++fileId)
+	{
+		m_TableToFileIds[m_FileToTableIds[fileId]] = static_cast<uint32>(fileId);
+	}
+	return true;
+}
+
+uint32 PathDatabaseFlatFile::ReadUInt32(int32 a_Offset) const
+{
+	//Written through FArchive in native byte order, which is little endian on every editor platform.
+	uint32 value;
+	FMemory::Memcpy(&value, m_Data->GetData() + a_Offset, sizeof(value));
+	return value;
+}
+
+NodeSignatureTable::SignatureId PathDatabaseFlatFile::ToTableId(uint32 a_FileId) const
+{
+	return (a_FileId < static_cast<uint32>(m_FileToTableIds.Num())) ? m_FileToTableIds[a_FileId] : NodeSignatureTable::INVALID_SIGNATURE_ID;
+}
+
+int32 PathDatabaseFlatFile::FindAnchorRecord(const DirectionSection& a_Section, uint32 a_FileAnchorId) const
+{
+	int32 low = 0;
+	int32 high = a_Section.m_NumAnchors;
+	while (low < high)
+	{
+		const int32 middle = low + (high - low) / 2;
+		if (ReadUInt32(a_Section.m_AnchorsOffset + middle * FLAT_FILE_ANCHOR_RECORD_SIZE) < a_FileAnchorId)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	const bool found = low < a_Section.m_NumAnchors && 
+		ReadUInt32(a_Section.m_AnchorsOffset + low * FLAT_FILE_ANCHOR_RECORD_SIZE) == a_FileAnchorId;
+	return found ? low : INDEX_NONE;
+}
+
+void PathDatabaseFlatFile::LoadAnchorRecord(EPathDirection a_Direction, int32 a_AnchorRecord, PredictionDatabase& a_Database)
+{
+	DirectionSection& section = GetSection(a_Direction);
+	section.m_LoadedAnchors[a_AnchorRecord] = true;
+	--m_NumPendingAnchors;
+
+	NodeSignatureTable::SignatureId anchorId;
+	uint32 firstEntry;
+	uint32 numEntries;
+	if (!ReadAnchorRecord(section, a_AnchorRecord, anchorId, firstEntry, numEntries))
+	{
+		UE_LOG(BILog, Warning, TEXT("Skipping malformed anchor record %i in suggestion database file"), a_AnchorRecord);
+		return;
+	}
+
+	PathPredictionList& predictions = a_Database.FindOrAdd(anchorId);
+	for (uint32 i = 0; i < numEntries; ++i)
+	{
+		const int32 entryOffset = section.m_EntriesOffset + static_cast<int32>(firstEntry + i) * m_EntryStride;
+
+		PathPredictionEntry entry;
+		entry.m_Direction = a_Direction;
+		entry.m_AnchorVertex = PathNodeEntry(anchorId);
+		entry.m_PredictionVertex = PathNodeEntry(ToTableId(ReadUInt32(entryOffset)));
+		entry.m_NumUses = static_cast<int32>(ReadUInt32(entryOffset + 4));
+		const int32 contextLength = FMath::Min(static_cast<int32>(ReadUInt32(entryOffset + 8)), m_ContextSlots);
+		for (int32 contextIndex = 0; contextIndex < contextLength; ++contextIndex)
+		{
+			entry.m_ContextPath.PushNode(PathNodeEntry(ToTableId(ReadUInt32(entryOffset + FLAT_FILE_ENTRY_HEADER_SIZE + 
+				contextIndex * sizeof(uint32)))));
+		}
+		predictions.AddUses(entry);
+	}
+}
+
+PathDatabaseFlatFile::DirectionSection& PathDatabaseFlatFile::GetSection(EPathDirection a_Direction)
+{
+	return (a_Direction == EPathDirection::Forward) ? m_ForwardSection : m_BackwardSection;
+}
+
+const PathDatabaseFlatFile::DirectionSection& PathDatabaseFlatFile::GetSection(EPathDirection a_Direction) const
+{
+	return (a_Direction == EPathDirection::Forward) ? m_ForwardSection : m_BackwardSection;
+}
+
+bool PathDatabaseFlatFile::ReadAnchorRecord(const DirectionSection& a_Section, int32 a_AnchorRecord, 
+	NodeSignatureTable::SignatureId& a_OutAnchorId, uint32& a_OutFirstEntry, uint32& a_OutNumEntries) const
+{
+	const int32 recordOffset = a_Section.m_AnchorsOffset + a_AnchorRecord * FLAT_FILE_ANCHOR_RECORD_SIZE;
+	a_OutAnchorId = ToTableId(ReadUInt32(recordOffset));
+	a_OutFirstEntry = ReadUInt32(recordOffset + 4);
+	a_OutNumEntries = ReadUInt32(recordOffset + 8);
+	return a_OutAnchorId != NodeSignatureTable::INVALID_SIGNATURE_ID && a_OutFirstEntry <= static_cast<uint32>(a_Section.m_NumEntries) && 
+		a_OutNumEntries <= static_cast<uint32>(a_Section.m_NumEntries) - a_OutFirstEntry;
+}
+
+void PathDatabaseFlatFile::GetPendingAnchors(EPathDirection a_Direction, TArray<WrittenAnchor>& a_OutAnchors) const
+{
+	const DirectionSection& section = GetSection(a_Direction);
+	for (int32 anchorRecord = 0; anchorRecord < section.m_NumAnchors; ++anchorRecord)
+	{
+		NodeSignatureTable::SignatureId anchorId;
+		uint32 firstEntry;
+		uint32 numEntries;
+		if (!section.m_LoadedAnchors[anchorRecord] && ReadAnchorRecord(section, anchorRecord, anchorId, firstEntry, numEntries) && numEntries > 0)
+		{
+			WrittenAnchor& anchor = a_OutAnchors[a_OutAnchors.AddUninitialized()];
+			anchor.m_AnchorId = anchorId;
+			anchor.m_Predictions = nullptr;
+			anchor.m_PendingRecord = anchorRecord;
+			anchor.m_NumEntries = numEntries;
+		}
+	}
+}
+
+void PathDatabaseFlatFile::WritePendingEntries(FArchive& a_Archive, EPathDirection a_Direction, const WrittenAnchor& a_Anchor, 
+	int32 a_ContextSlots) const
+{
+	//The same entries LoadAnchorRecord would decode, with file ids translated to table ids and the context padded to a_ContextSlots.
+	const DirectionSection& section = GetSection(a_Direction);
+	const uint32 firstEntry = ReadUInt32(section.m_AnchorsOffset + a_Anchor.m_PendingRecord * FLAT_FILE_ANCHOR_RECORD_SIZE + 4);
+	for (uint32 i = 0; i < a_Anchor.m_NumEntries; ++i)
+	{
+		const int32 entryOffset = section.m_EntriesOffset + static_cast<int32>(firstEntry + i) * m_EntryStride;
+		uint32 predictionId = ToTableId(ReadUInt32(entryOffset));
+		int32 numUses = static_cast<int32>(ReadUInt32(entryOffset + 4));
+		uint32 contextLength = FMath::Min(ReadUInt32(entryOffset + 8), static_cast<uint32>(FMath::Min(m_ContextSlots, a_ContextSlots)));
+		a_Archive << predictionId << numUses << contextLength;
+		for (int32 contextIndex = 0; contextIndex < a_ContextSlots; ++contextIndex)
+		{
+			uint32 contextId = (contextIndex < static_cast<int32>(contextLength)) ? 
+				ToTableId(ReadUInt32(entryOffset + FLAT_FILE_ENTRY_HEADER_SIZE + contextIndex * sizeof(uint32))) : 
+				NodeSignatureTable::INVALID_SIGNATURE_ID;
+			a_Archive << contextId;
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "EPathDirection.h"
+#include "NodeSignatureTable.h"
+#include "PathPredictionList.h"
+
+/** Flat on-disk layout of the path prediction database, read with a single bulk read and decoded in place one anchor at a time.
+ * Startup only interns the signature guids; signature strings, titles and entries are decoded when they are first used.
+ *
+ * Layout (little endian, following the version number written by SuggestionDatabasePath::Serialize):
+ *   Header          numSignatures, stringTableSize, contextSlots, numAnchors[Forward, Backward], numEntries[Forward, Backward]
+ *   Signatures      numSignatures x (guid, signature string offset, title string offset), file ids start at 1
+ *   String table    null terminated UTF-8 strings
+ *   Per direction   numAnchors x (anchor id, first entry, entry count) sorted on anchor id, 
+ *                   numEntries x (prediction id, uses, context length, contextSlots x context id) */
+class PathDatabaseFlatFile
+{
+public:
+	typedef TMap<NodeSignatureTable::SignatureId, PathPredictionList> PredictionDatabase;
+
+	/** Takes the file contents following the version number. Returns an invalid pointer when the contents are malformed */
+	static TSharedPtr<PathDatabaseFlatFile> Load(TArray<uint8>& a_FileData);
+	/** Writes the databases, together with the anchors of a_PendingAnchors that were never decoded into them.
+	 * Those are copied from the loaded file with only their ids translated. a_PendingAnchors may be nullptr */
+	static void Write(FArchive& a_Archive, const PredictionDatabase& a_ForwardDatabase, const PredictionDatabase& a_BackwardDatabase,
+		const PathDatabaseFlatFile* a_PendingAnchors);
+
+	~PathDatabaseFlatFile();
+
+	/** Copy that keeps the current set of pending anchors, so it can be written on another thread while this one keeps decoding.
+	 * The file contents are shared, not copied */
+	TSharedRef<PathDatabaseFlatFile> CopyPendingAnchors() const;
+	int32 NumPendingAnchors() const;
+	/** Maps the signature ids stored in the file to the ids in NodeSignatureTable, index 0 is the invalid id */
+	const TArray<NodeSignatureTable::SignatureId>& GetFileToTableIds() const;
+	/** Decodes the entries of a_AnchorId into a_Database. Every anchor is decoded once, returns false if nothing was added */
+	bool LoadAnchor(EPathDirection a_Direction, NodeSignatureTable::SignatureId a_AnchorId, PredictionDatabase& a_Database);
+	void LoadAllAnchors(PredictionDatabase& a_ForwardDatabase, PredictionDatabase& a_BackwardDatabase);
+
+private:
+	struct DirectionSection
+	{
+		int32 m_AnchorsOffset;
+		int32 m_NumAnchors;
+		int32 m_EntriesOffset;
+		int32 m_NumEntries;
+		TBitArray<> m_LoadedAnchors;
+	};
+
+	/** Anchor of a_Direction that is written to a file, either from a database or still pending in a loaded file */
+	struct WrittenAnchor
+	{
+		NodeSignatureTable::SignatureId m_AnchorId;
+		const PathPredictionList* m_Predictions; //nullptr if the anchor is pending
+		int32 m_PendingRecord;
+		uint32 m_NumEntries;
+
+		inline bool operator < (const WrittenAnchor& a_Other) const
+		{
+			return m_AnchorId < a_Other.m_AnchorId;
+		}
+	};
+
+	PathDatabaseFlatFile(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& a_Data);
+	bool ParseHeader();
+
+	/** Adds the anchors of a_Direction that were not decoded yet to a_OutAnchors, skipping malformed records */
+	void GetPendingAnchors(EPathDirection a_Direction, TArray<WrittenAnchor>& a_OutAnchors) const;
+	void WritePendingEntries(FArchive& a_Archive, EPathDirection a_Direction, const WrittenAnchor& a_Anchor, int32 a_ContextSlots) const;
+	/** Validates an anchor record, returning false if it cannot be decoded */
+	bool ReadAnchorRecord(const DirectionSection& a_Section, int32 a_AnchorRecord, NodeSignatureTable::SignatureId& a_OutAnchorId, 
+		uint32& a_OutFirstEntry, uint32& a_OutNumEntries) const;
+	const DirectionSection& GetSection(EPathDirection a_Direction) const;
+
+	uint32 ReadUInt32(int32 a_Offset) const;
+	NodeSignatureTable::SignatureId ToTableId(uint32 a_FileId) const;
+	int32 FindAnchorRecord(const DirectionSection& a_Section, uint32 a_FileAnchorId) const;
+	void LoadAnchorRecord(EPathDirection a_Direction, int32 a_AnchorRecord, PredictionDatabase& a_Database);
+	DirectionSection& GetSection(EPathDirection a_Direction);
+
+	TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> m_Data;
+	int32 m_ContextSlots;
+	int32 m_EntryStride;
+	DirectionSection m_ForwardSection;
+	DirectionSection m_BackwardSection;
+	int32 m_NumPendingAnchors;
+
+	TArray<NodeSignatureTable::SignatureId> m_FileToTableIds;
+	TArray<uint32> m_TableToFileIds;
+};
@@ -0,0 +1,322 @@
+#include "BIPluginPrivatePCH.h"
+#include "PathDatabaseJournal.h"
+
+namespace
+{
+	const uint32 JOURNAL_MAGIC = 0x4C4A4942; //"BIJL"
+	const uint32 JOURNAL_VERSION = 2;
+	const uint32 NO_BLUEPRINT_ID = 0;
+
+	enum class EJournalRecordType : uint8
+	{
+		SignatureDefinition,
+		Delta,
+		BlueprintDefinition
+	};
+}
+
+PathDatabaseJournal::PathDatabaseJournal(const FString& a_FilePath)
+	: m_FilePath(a_FilePath)
+	, m_Writer(nullptr)
+	, m_FileSize(0)
+	, m_LastSequence(0)
+{
+}
+
+PathDatabaseJournal::~PathDatabaseJournal()
+{
+	if (m_Writer != nullptr)
+	{
+		m_Writer->Close();
+		delete m_Writer;
+	}
+}
+
+void PathDatabaseJournal::Open(uint64 a_SnapshotSequence, TArray<JournalDelta>& a_OutDeltas)
+{
+	m_LastSequence = a_SnapshotSequence;
+	m_Records.Empty();
+
+	TArray<uint8> fileData;
+	if (FFileHelper::LoadFileToArray(fileData, *m_FilePath, FILEREAD_Silent))
+	{
+		ReadRecords(fileData, a_SnapshotSequence);
+	}
+
+	//Rewriting drops the deltas the snapshot already contains, as well as a torn record at the end.
+	RewriteFile();
+
+	for (const JournalRecord& record : m_Records)
+	{
+		a_OutDeltas.Add(record.m_Delta);
+	}
+}
+
+void PathDatabaseJournal::Append(const JournalDelta& a_Delta)
+{
+	if (m_Writer == nullptr)
+	{
+		return;
+	}
+
+	JournalRecord& record = m_Records[m_Records.AddDefaulted()];
+	record.m_Sequence = ++m_LastSequence;
+	record.m_Delta = a_Delta;
+	WriteDelta(*m_Writer, record);
+}
+
+void PathDatabaseJournal::Flush()
+{
+	if (m_Writer != nullptr)
+	{
+		m_Writer->Flush();
+	}
+}
+
+void PathDatabaseJournal::Compact(uint64 a_SavedSequence)
+{
+	m_Records.RemoveAll([a_SavedSequence](const JournalRecord& a_Record)
+	{
+		return a_Record.m_Sequence <= a_SavedSequence;
+	});
+	RewriteFile();
+}
+
+uint64 PathDatabaseJournal::GetLastSequence() const
+{
+	return m_LastSequence;
+}
+
+int64 PathDatabaseJournal::GetFileSize() const
+{
+	return m_FileSize;
+}
+
+void PathDatabaseJournal::ReadRecords(const TArray<uint8>& a_FileData, uint64 a_SnapshotSequence)
+{
+	FMemoryReader fileReader(a_FileData);
+	uint32 magic = 0;
+	uint32 version = 0;
+	if (a_FileData.Num() >= 2 * sizeof(uint32))
+	{
+		fileReader << magic << version;
+	}
+	if (magic != JOURNAL_MAGIC || version != JOURNAL_VERSION)
+	{
+		UE_LOG(BILog, Warning, TEXT("Ignoring suggestion journal '%s', unknown format"), *m_FilePath);
+		return;
+	}
+
+	TMap<uint32, NodeSignatureTable::SignatureId> journalToTableIds;
+	TMap<uint32, FName> journalToBlueprints;
+	journalToBlueprints.Add(NO_BLUEPRINT_ID, NAME_None);
+	int32 numReplayed = 0;
+	while (fileReader.Tell() + static_cast<int64>(sizeof(uint32)) <= fileReader.TotalSize())
+	{
+		uint32 payloadSize = 0;
+		fileReader << payloadSize;
+		if (fileReader.Tell() + payloadSize > fileReader.TotalSize())
+		{
+			UE_LOG(BILog, Warning, TEXT("Suggestion journal '%s' ends in an incomplete record, ignoring it"), *m_FilePath);
+			break;
+		}
+
+		TArray<uint8> payload;
+		payload.AddUninitialized(payloadSize);
+		fileReader.Serialize(payload.GetData(), payloadSize);
+		FMemoryReader payloadReader(payload);
+
+		uint8 recordType = 0;
+		payloadReader << recordType;
+		if (recordType == static_cast<uint8>(EJournalRecordType::SignatureDefinition))
+		{
+			uint32 journalId = 0;
+			FGuid signatureGuid;
+			FString signature;
+			FString title;
+			payloadReader << journalId << signatureGuid << signature << title;
+			journalToTableIds.Add(journalId, NodeSignatureTable::Get().FindOrAdd(signatureGuid, 
+				FBlueprintNodeSignature(signature), FText::FromString(title)));
+		}
+		else if (recordType == static_cast<uint8>(EJournalRecordType::BlueprintDefinition))
+		{
+			uint32 journalId = 0;
+			FString blueprintName;
+			payloadReader << journalId << blueprintName;
+			journalToBlueprints.Add(journalId, FName(*blueprintName));
+		}
+		else if (recordType == static_cast<uint8>(EJournalRecordType::Delta))
+		{
+			JournalRecord record;
+			PathPredictionEntry& entry = record.m_Delta.m_Entry;
+			uint32 blueprintId = NO_BLUEPRINT_ID;
+			uint8 direction = 0;
+			uint32 anchorId = 0;
+			uint32 predictionId = 0;
+			int32 contextLength = 0;
+			payloadReader << record.m_Sequence << blueprintId << direction << anchorId << predictionId << contextLength;
+
+			const FName* blueprint = journalToBlueprints.Find(blueprintId);
+			const NodeSignatureTable::SignatureId* anchorTableId = journalToTableIds.Find(anchorId);
+			const NodeSignatureTable::SignatureId* predictionTableId = journalToTableIds.Find(predictionId);
+			bool isValid = blueprint != nullptr && anchorTableId != nullptr && predictionTableId != nullptr && 
+				contextLength >= 0 && contextLength <= PathContextPath::MAX_CONTEXT_PATH_LENGTH;
+			for (int32 i = 0; isValid && i < contextLength; ++i)
+			{
+				uint32 contextId = 0;
+				payloadReader << contextId;
+				const NodeSignatureTable::SignatureId* contextTableId = journalToTableIds.Find(contextId);
+				isValid = contextTableId != nullptr;
+				if (isValid)
+				{
+					entry.m_ContextPath.PushNode(PathNodeEntry(*contextTableId));
+				}
+			}
+			payloadReader << entry.m_NumUses;
+
+			if (!isValid || payloadReader.IsError())
+			{
+				UE_LOG(BILog, Warning, TEXT("Skipping malformed record in suggestion journal '%s'"), *m_FilePath);
+				continue;
+			}
+
+			entry.m_Direction = (direction == 0) ? EPathDirection::Forward : EPathDirection::Backward;
+			entry.m_AnchorVertex = PathNodeEntry(*anchorTableId);
+			entry.m_PredictionVertex = PathNodeEntry(*predictionTableId);
+			record.m_Delta.m_Blueprint = *blueprint;
+			m_LastSequence = FMath::Max(m_LastSequence, record.m_Sequence);
+			if (record.m_Sequence > a_SnapshotSequence)
+			{
+				m_Records.Add(record);
+				++numReplayed;
+			}
+		}
+	}
+
+	UE_LOG(BILog, Log, TEXT("Replaying %i learned links from suggestion journal '%s'"), numReplayed, *m_FilePath);
+}
+
+void PathDatabaseJournal::RewriteFile()
+{
+	if (m_Writer != nullptr)
+	{
+		m_Writer->Close();
+		delete m_Writer;
+		m_Writer = nullptr;
+	}
+
+	const FString temporaryFilePath = m_FilePath + TEXT(".tmp");
+	FArchive* fileArchive = IFileManager::Get().CreateFileWriter(*temporaryFilePath);
+	if (fileArchive == nullptr)
+	{
+		UE_LOG(BILog, Warning, TEXT("Could not open '%s', learned links will not be journaled"), *temporaryFilePath);
+		return;
+	}
+
+	m_DefinedSignatures.Empty();
+	m_DefinedBlueprints.Empty();
+	uint32 magic = JOURNAL_MAGIC;
+	uint32 version = JOURNAL_VERSION;
+	*fileArchive << magic << version;
+	m_FileSize = 2 * sizeof(uint32);
+	for (const JournalRecord& record : m_Records)
+	{
+		WriteDelta(*fileArchive, record);
+	}
+
+	const bool wroteFile = fileArchive->Close();
+	delete fileArchive;
+	if (!wroteFile || !IFileManager::Get().Move(*m_FilePath, *temporaryFilePath, true, true))
+	{
+		UE_LOG(BILog, Warning, TEXT("Could not write suggestion journal '%s', learned links will not be journaled"), *m_FilePath);
+		return;
+	}
+
+	m_Writer = IFileManager::Get().CreateFileWriter(*m_FilePath, FILEWRITE_Append);
+}
+
+void PathDatabaseJournal::WriteDelta(FArchive& a_Archive, const JournalRecord& a_Record)
+{
+	const PathPredictionEntry& delta = a_Record.m_Delta.m_Entry;
+	uint32 blueprintId = WriteBlueprintDefinition(a_Archive, a_Record.m_Delta.m_Blueprint);
+	WriteSignatureDefinition(a_Archive, delta.m_AnchorVertex.m_SignatureId);
+	WriteSignatureDefinition(a_Archive, delta.m_PredictionVertex.m_SignatureId);
+	for (int32 i = 0; i < delta.m_ContextPath.Num(); ++i)
+	{
+		WriteSignatureDefinition(a_Archive, delta.m_ContextPath.GetNode(i).m_SignatureId);
+	}
+
+	TArray<uint8> payload;
+	FMemoryWriter payloadWriter(payload);
+	uint8 recordType = static_cast<uint8>(EJournalRecordType::Delta);
+	uint64 sequence = a_Record.m_Sequence;
+	uint8 direction = (delta.m_Direction == EPathDirection::Forward) ? 0 : 1;
+	uint32 anchorId = delta.m_AnchorVertex.m_SignatureId;
+	uint32 predictionId = delta.m_PredictionVertex.m_SignatureId;
+	int32 contextLength = delta.m_ContextPath.Num();
+	payloadWriter << recordType << sequence << blueprintId << direction << anchorId << predictionId << contextLength;
+	for (int32 i = 0; i < contextLength; ++i)
+	{
+		uint32 contextId = delta.m_ContextPath.GetNode(i).m_SignatureId;
+		payloadWriter << contextId;
+	}
+	int32 numUses = delta.m_NumUses;
+	payloadWriter << numUses;
+
+	WritePayload(a_Archive, payload);
+}
+
+void PathDatabaseJournal::WriteSignatureDefinition(FArchive& a_Archive, NodeSignatureTable::SignatureId a_SignatureId)
+{
+	if (m_DefinedSignatures.Contains(a_SignatureId))
+	{
+		return;
+	}
+	m_DefinedSignatures.Add(a_SignatureId);
+
+	const NodeSignatureTable& signatureTable = NodeSignatureTable::Get();
+	TArray<uint8> payload;
+	FMemoryWriter payloadWriter(payload);
+	uint8 recordType = static_cast<uint8>(EJournalRecordType::SignatureDefinition);
+	uint32 journalId = a_SignatureId;
+	FGuid signatureGuid = signatureTable.GetSignatureGuid(a_SignatureId);
+	FString signature = signatureTable.GetSignature(a_SignatureId).ToString();
+	FString title = signatureTable.GetTitle(a_SignatureId).ToString();
+	payloadWriter << recordType << journalId << signatureGuid << signature << title;
+
+	WritePayload(a_Archive, payload);
+}
+
+uint32 PathDatabaseJournal::WriteBlueprintDefinition(FArchive& a_Archive, FName a_Blueprint)
+{
+	if (a_Blueprint == NAME_None)
+	{
+		return NO_BLUEPRINT_ID;
+	}
+	const uint32* existingId = m_DefinedBlueprints.Find(a_Blueprint);
+	if (existingId != nullptr)
+	{
+		return *existingId;
+	}
+
+	uint32 journalId = m_DefinedBlueprints.Num() + 1;
+	m_DefinedBlueprints.Add(a_Blueprint, journalId);
+
+	TArray<uint8> payload;
+	FMemoryWriter payloadWriter(payload);
+	uint8 recordType = static_cast<uint8>(EJournalRecordType::BlueprintDefinition);
+	FString blueprintName = a_Blueprint.ToString();
+	payloadWriter << recordType << journalId << blueprintName;
+
+	WritePayload(a_Archive, payload);
+	return journalId;
+}
+
+void PathDatabaseJournal::WritePayload(FArchive& a_Archive, TArray<uint8>& a_Payload)
+{
+	//Records are length prefixed so a record torn by a crash can be detected when replaying.
+	uint32 payloadSize = a_Payload.Num();
+	a_Archive << payloadSize;
+	a_Archive.Serialize(a_Payload.GetData(), a_Payload.Num());
+	m_FileSize += sizeof(payloadSize) + payloadSize;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "PathPredictionEntry.h"
+
+/** Append-only log of the prediction entries learned since the last saved snapshot of the database.
+ * Every delta gets a sequence number; snapshots store the last sequence they contain, so replaying skips what they already hold.
+ * Signatures and blueprint names are written once per file as definition records, deltas refer to them by id. */
+class PathDatabaseJournal
+{
+public:
+	struct JournalDelta
+	{
+		PathPredictionEntry m_Entry; //m_NumUses is the change in uses
+		FName m_Blueprint; //Blueprint the change is attributed to, NAME_None if there is none
+	};
+
+	PathDatabaseJournal(const FString& a_FilePath);
+	~PathDatabaseJournal();
+
+	/** Reads the deltas newer than a_SnapshotSequence into a_OutDeltas, drops the older ones and opens the file for appending.
+	 * A record torn by a crash ends the replay. */
+	void Open(uint64 a_SnapshotSequence, TArray<JournalDelta>& a_OutDeltas);
+	/** Buffers a_Delta, it is only guaranteed to be on disk after the next Flush */
+	void Append(const JournalDelta& a_Delta);
+	/** Writes the buffered deltas to disk. Called once per learned change instead of per delta, a change appends many deltas */
+	void Flush();
+	/** Removes all deltas up to and including a_SavedSequence, as they are stored in a snapshot on disk now */
+	void Compact(uint64 a_SavedSequence);
+
+	uint64 GetLastSequence() const;
+	int64 GetFileSize() const;
+
+private:
+	struct JournalRecord
+	{
+		uint64 m_Sequence;
+		JournalDelta m_Delta;
+	};
+
+	void ReadRecords(const TArray<uint8>& a_FileData, uint64 a_SnapshotSequence);
+	void RewriteFile();
+	void WriteDelta(FArchive& a_Archive, const JournalRecord& a_Record);
+	void WriteSignatureDefinition(FArchive& a_Archive, NodeSignatureTable::SignatureId a_SignatureId);
+	uint32 WriteBlueprintDefinition(FArchive& a_Archive, FName a_Blueprint);
+	void WritePayload(FArchive& a_Archive, TArray<uint8>& a_Payload);
+
+	FString m_FilePath;
+	FArchive* m_Writer;
+	int64 m_FileSize;
+	uint64 m_LastSequence;
+	TArray<JournalRecord> m_Records;
+	TSet<NodeSignatureTable::SignatureId> m_DefinedSignatures;
+	TMap<FName, uint32> m_DefinedBlueprints;
+};
@@ -0,0 +1,135 @@
+#include "BIPluginPrivatePCH.h"
+#include "PathGraphSnapshot.h"
+
+#include "NodeSignatureCache.h"
+
+PathGraphSnapshot::PathGraphSnapshot()
+{
+}
+
+PathGraphSnapshot::PathGraphSnapshot(const UEdGraph& a_Graph, FName a_Blueprint)
+	: m_Blueprint(a_Blueprint)
+{
+	TArray<UK2Node*> nodes;
+	a_Graph.GetNodesOfClass(nodes);
+
+	TMap<const UEdGraphNode*, int32> nodeIndices;
+	nodeIndices.Reserve(nodes.Num());
+	m_SignatureIds.Reserve(nodes.Num());
+	for (UK2Node* node : nodes)
+	{
+		nodeIndices.Add(node, AddNode(NodeSignatureCache::Get().FindOrAdd(*node)));
+	}
+
+	//Walks the pins the same way LiveGraphPathSource does, so the snapshot yields the same paths as the live graph.
+	for (int32 i = 0; i < nodes.Num(); ++i)
+	{
+		for (const UEdGraphPin* pin : nodes[i]->Pins)
+		{
+			if (pin->bHidden || pin->bNotConnectable)
+			{
+				continue;
+			}
+
+			const EPathDirection direction = (pin->Direction == EEdGraphPinDirection::EGPD_Input) ?
+				EPathDirection::Forward : EPathDirection::Backward;
+			for (const UEdGraphPin* linkedPin : pin->LinkedTo)
+			{
+				const int32* linkedNode = nodeIndices.Find(linkedPin->GetOwningNode());
+				if (linkedNode != nullptr)
+				{
+					AddNeighbour(i, direction, *linkedNode);
+				}
+			}
+		}
+	}
+	Finalize();
+}
+
+PathGraphSnapshot::~PathGraphSnapshot()
+{
+}
+
+int32 PathGraphSnapshot::AddNode(NodeSignatureTable::SignatureId a_SignatureId)
+{
+	return m_SignatureIds.Add(a_SignatureId);
+}
+
+void PathGraphSnapshot::AddLink(int32 a_OutputNode, int32 a_InputNode)
+{
+	AddNeighbour(a_InputNode, EPathDirection::Forward, a_OutputNode);
+	AddNeighbour(a_OutputNode, EPathDirection::Backward, a_InputNode);
+}
+
+void PathGraphSnapshot::Finalize()
+{
+	FinalizeNeighbourList(m_ForwardNeighbours);
+	FinalizeNeighbourList(m_BackwardNeighbours);
+}
+
+int32 PathGraphSnapshot::Num() const
+{
+	return m_SignatureIds.Num();
+}
+
+FName PathGraphSnapshot::GetBlueprint() const
+{
+	return m_Blueprint;
+}
+
+NodeSignatureTable::SignatureId PathGraphSnapshot::GetSignatureId(int32 a_Node) const
+{
+	return m_SignatureIds[a_Node];
+}
+
+const int32* PathGraphSnapshot::GetNeighbours(int32 a_Node, EPathDirection a_Direction, int32& a_OutNumNeighbours) const
+{
+	const NeighbourList& list = GetNeighbourList(a_Direction);
+	checkSlow(list.m_PendingLinks.Num() == 0);
+	const int32 first = list.m_Offsets[a_Node];
+	a_OutNumNeighbours = list.m_Offsets[a_Node + 1] - first;
+	return list.m_Neighbours.GetData() + first;
+}
+
+void PathGraphSnapshot::AddNeighbour(int32 a_Node, EPathDirection a_Direction, int32 a_Neighbour)
+{
+	TArray<PendingLink>& pendingLinks = GetNeighbourList(a_Direction).m_PendingLinks;
+	PendingLink& link = pendingLinks[pendingLinks.AddUninitialized()];
+	link.m_Node = a_Node;
+	link.m_Neighbour = a_Neighbour;
+}
+
+void PathGraphSnapshot::FinalizeNeighbourList(NeighbourList& a_List)
+{
+	//Counting sort on the node, which keeps the order links were added in for each node.
+	const TArray<PendingLink>& links = a_List.m_PendingLinks;
+	a_List.m_Offsets.Reset();
+	a_List.m_Offsets.AddZeroed(Num() + 1);
+	for (const PendingLink& link : links)
+	{
+		a_List.m_Offsets[link.m_Node + 1]++;
+	}
+	for (int32 node = 0; node < Num(); ++node)
+	{
+		a_List.m_Offsets[node + 1] += a_List.m_Offsets[node];
+	}
+
+	TArray<int32> nextNeighbour(a_List.m_Offsets.GetData(), Num());
+	a_List.m_Neighbours.Reset();
+	a_List.m_Neighbours.AddUninitialized(links.Num());
+	for (const PendingLink& link : links)
+	{
+		a_List.m_Neighbours[nextNeighbour[link.m_Node]++] = link.m_Neighbour;
+	}
+	a_List.m_PendingLinks.Empty();
+}
+
+const PathGraphSnapshot::NeighbourList& PathGraphSnapshot::GetNeighbourList(EPathDirection a_Direction) const
+{
+	return (a_Direction == EPathDirection::Forward) ? m_ForwardNeighbours : m_BackwardNeighbours;
+}
+
+PathGraphSnapshot::NeighbourList& PathGraphSnapshot::GetNeighbourList(EPathDirection a_Direction)
+{
+	return (a_Direction == EPathDirection::Forward) ? m_ForwardNeighbours : m_BackwardNeighbours;
+}
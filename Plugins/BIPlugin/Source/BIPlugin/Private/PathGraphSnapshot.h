@@ -0,0 +1,53 @@
+#pragma once
+
+#include "EPathDirection.h"
+#include "NodeSignatureTable.h"
+
+/** Copy of the node connectivity of one graph with interned signatures, so paths can be extracted without touching UObjects
+ * or computing signatures more than once per node. Neighbours are packed per direction into one array with per node offsets.
+ * Has to be created on the game thread, can be read from any thread afterwards. */
+class PathGraphSnapshot
+{
+public:
+	PathGraphSnapshot();
+	/** a_Blueprint is the name the paths of this graph are attributed to, see SuggestionDatabaseBase::GetBlueprintName */
+	PathGraphSnapshot(const UEdGraph& a_Graph, FName a_Blueprint);
+	~PathGraphSnapshot();
+
+	int32 AddNode(NodeSignatureTable::SignatureId a_SignatureId);
+	/** Links an output pin of a_OutputNode to an input pin of a_InputNode */
+	void AddLink(int32 a_OutputNode, int32 a_InputNode);
+	/** Packs the added links into the neighbour arrays. Has to be called once after the last AddLink, before neighbours are read */
+	void Finalize();
+
+	int32 Num() const;
+	FName GetBlueprint() const;
+	NodeSignatureTable::SignatureId GetSignatureId(int32 a_Node) const;
+	/** Nodes reached when exploring from a_Node in a_Direction, once per link like the live graph walk */
+	const int32* GetNeighbours(int32 a_Node, EPathDirection a_Direction, int32& a_OutNumNeighbours) const;
+
+private:
+	struct PendingLink
+	{
+		int32 m_Node;
+		int32 m_Neighbour;
+	};
+
+	struct NeighbourList
+	{
+		/** Neighbours of node i are m_Neighbours[m_Offsets[i]] up to m_Neighbours[m_Offsets[i + 1]] */
+		TArray<int32> m_Offsets;
+		TArray<int32> m_Neighbours;
+		TArray<PendingLink> m_PendingLinks;
+	};
+
+	void AddNeighbour(int32 a_Node, EPathDirection a_Direction, int32 a_Neighbour);
+	void FinalizeNeighbourList(NeighbourList& a_List);
+	const NeighbourList& GetNeighbourList(EPathDirection a_Direction) const;
+	NeighbourList& GetNeighbourList(EPathDirection a_Direction);
+
+	TArray<NodeSignatureTable::SignatureId> m_SignatureIds;
+	NeighbourList m_ForwardNeighbours;
+	NeighbourList m_BackwardNeighbours;
+	FName m_Blueprint;
+};
@@ -1,32 +1,49 @@
 #include "BIPluginPrivatePCH.h"
 #include "PathNodeEntry.h"
 
+#include "NodeSignatureCache.h"
+
 PathNodeEntry::PathNodeEntry()
-	: m_NodeSignature("DEFAULT_INVALID_SIGNATURE")
+	: m_SignatureId(NodeSignatureTable::INVALID_SIGNATURE_ID)
+{
+}
+
+PathNodeEntry::PathNodeEntry(NodeSignatureTable::SignatureId a_SignatureId)
+	: m_SignatureId(a_SignatureId)
 {
 }
 
 PathNodeEntry::PathNodeEntry(const UK2Node& a_Node)
-	: m_NodeSignature(a_Node.GetSignature())
-	, m_NodeSignatureGuid(m_NodeSignature.AsGuid())
-	, m_NodeTitle(a_Node.GetNodeTitle(ENodeTitleType::MenuTitle))
+	: m_SignatureId(NodeSignatureCache::Get().FindOrAdd(a_Node))
 {
 }
 
 bool PathNodeEntry::operator ==(const PathNodeEntry& a_Other) const
 {
-	return m_NodeSignatureGuid == a_Other.m_NodeSignatureGuid;
+	return m_SignatureId == a_Other.m_SignatureId;
 }
 
 uint32 GetTypeHash(const PathNodeEntry& a_Instance)
 {
-	return GetTypeHash(a_Instance.m_NodeSignatureGuid);
+	return GetTypeHash(a_Instance.m_SignatureId);
 }
 
 FArchive& operator << (FArchive& a_Archive, PathNodeEntry& a_Value)
 {
-	FString nodeSignature = a_Value.m_NodeSignature.ToString();
-	a_Archive << nodeSignature << a_Value.m_NodeSignatureGuid << a_Value.m_NodeTitle;
-	a_Value.m_NodeSignature = FBlueprintNodeSignature(nodeSignature);
-	return a_Archive;
+	return a_Archive << a_Value.m_SignatureId;
+}
+
+FBlueprintNodeSignature PathNodeEntry::GetSignature() const
+{
+	return NodeSignatureTable::Get().GetSignature(m_SignatureId);
+}
+
+FGuid PathNodeEntry::GetSignatureGuid() const
+{
+	return NodeSignatureTable::Get().GetSignatureGuid(m_SignatureId);
+}
+
+FText PathNodeEntry::GetTitle() const
+{
+	return NodeSignatureTable::Get().GetTitle(m_SignatureId);
 }
@@ -1,15 +1,20 @@
 #pragma once
 
+#include "NodeSignatureTable.h"
+
 class PathNodeEntry
 {
 public:
 	PathNodeEntry();
+	explicit PathNodeEntry(NodeSignatureTable::SignatureId a_SignatureId);
 	PathNodeEntry(const UK2Node& a_Node);
 	bool operator ==(const PathNodeEntry& a_Other) const;
 	friend uint32 GetTypeHash(const PathNodeEntry& a_Instance);
 	friend FArchive& operator << (FArchive& a_Archive, PathNodeEntry& a_Value);
 
-	FBlueprintNodeSignature m_NodeSignature;
-	FGuid m_NodeSignatureGuid;
-	FText m_NodeTitle;
+	FBlueprintNodeSignature GetSignature() const;
+	FGuid GetSignatureGuid() const;
+	FText GetTitle() const;
+
+	NodeSignatureTable::SignatureId m_SignatureId;
 };
\ No newline at end of file
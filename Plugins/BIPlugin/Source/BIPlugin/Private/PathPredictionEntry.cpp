@@ -17,9 +17,18 @@ bool PathPredictionEntry::CompareExcludingUses(const PathPredictionEntry& a_Othe
 		m_ContextPath == a_Other.m_ContextPath;
 }
 
+void PathPredictionEntry::RemapSignatureIds(const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds)
+{
+	m_PredictionVertex.m_SignatureId = a_FileToTableIds[m_PredictionVertex.m_SignatureId];
+	m_AnchorVertex.m_SignatureId = a_FileToTableIds[m_AnchorVertex.m_SignatureId];
+	m_ContextPath.RemapSignatureIds(a_FileToTableIds);
+}
+
 FArchive& operator << (FArchive& a_Archive, PathPredictionEntry& a_Value)
 {
 	int32 direction = (int32)a_Value.m_Direction;
-	return a_Archive << direction << a_Value.m_PredictionVertex << a_Value.m_AnchorVertex << a_Value.m_ContextPath << 
+	a_Archive << direction << a_Value.m_PredictionVertex << a_Value.m_AnchorVertex << a_Value.m_ContextPath << 
 		a_Value.m_NumUses;
+	a_Value.m_Direction = (EPathDirection)direction;
+	return a_Archive;
 }
@@ -0,0 +1,150 @@
+#include "BIPluginPrivatePCH.h"
+#include "PathPredictionList.h"
+
+PathPredictionList::EntryKey::EntryKey(const PathPredictionEntry& a_Entry)
+	: m_PredictionVertex(a_Entry.m_PredictionVertex)
+	, m_ContextPath(a_Entry.m_ContextPath)
+{
+}
+
+bool PathPredictionList::EntryKey::operator ==(const EntryKey& a_Other) const
+{
+	return m_PredictionVertex == a_Other.m_PredictionVertex && m_ContextPath == a_Other.m_ContextPath;
+}
+
+uint32 GetTypeHash(const PathPredictionList::EntryKey& a_Instance)
+{
+	return GetTypeHash(a_Instance.m_PredictionVertex) ^ (GetTypeHash(a_Instance.m_ContextPath) * 31);
+}
+
+PathPredictionList::SignatureEntries::SignatureEntries()
+	: m_NumUses(0)
+{
+}
+
+PathPredictionList::PathPredictionList()
+{
+}
+
+PathPredictionList::~PathPredictionList()
+{
+}
+
+void PathPredictionList::AddUses(const PathPredictionEntry& a_Entry)
+{
+	const EntryKey key(a_Entry);
+	const int32* entryIndex = m_EntryIndex.Find(key);
+	if (entryIndex != nullptr)
+	{
+		const int32 index = *entryIndex;
+		PathPredictionEntry& entry = m_Entries[index];
+		if (entry.m_NumUses + a_Entry.m_NumUses <= 0)
+		{
+			RemoveEntry(index);
+		}
+		else
+		{
+			entry.m_NumUses += a_Entry.m_NumUses;
+			m_SignatureEntries.FindChecked(entry.m_PredictionVertex.m_SignatureId).m_NumUses += a_Entry.m_NumUses;
+		}
+	}
+	else if (a_Entry.m_NumUses > 0)
+	{
+		const int32 index = m_Entries.Add(a_Entry);
+		m_EntryIndex.Add(key, index);
+		AddSignatureEntry(a_Entry.m_PredictionVertex.m_SignatureId, index);
+	}
+}
+
+void PathPredictionList::RemapSignatureIds(const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds)
+{
+	for (PathPredictionEntry& entry : m_Entries)
+	{
+		entry.RemapSignatureIds(a_FileToTableIds);
+	}
+	RebuildIndex();
+}
+
+const TArray<PathPredictionEntry>& PathPredictionList::GetEntries() const
+{
+	return m_Entries;
+}
+
+int32 PathPredictionList::Num() const
+{
+	return m_Entries.Num();
+}
+
+const TArray<NodeSignatureTable::SignatureId>& PathPredictionList::GetSignatureIds() const
+{
+	return m_SignatureIds;
+}
+
+const TArray<int32>* PathPredictionList::FindEntryIndices(NodeSignatureTable::SignatureId a_SignatureId) const
+{
+	const SignatureEntries* signatureEntries = m_SignatureEntries.Find(a_SignatureId);
+	return (signatureEntries != nullptr) ? &signatureEntries->m_EntryIndices : nullptr;
+}
+
+int32 PathPredictionList::GetSignatureUses(NodeSignatureTable::SignatureId a_SignatureId) const
+{
+	const SignatureEntries* signatureEntries = m_SignatureEntries.Find(a_SignatureId);
+	return (signatureEntries != nullptr) ? signatureEntries->m_NumUses : 0;
+}
+
+FArchive& operator << (FArchive& a_Archive, PathPredictionList& a_Value)
+{
+	a_Archive << a_Value.m_Entries;
+	if (a_Archive.IsLoading())
+	{
+		a_Value.RebuildIndex();
+	}
+	return a_Archive;
+}
+
+void PathPredictionList::RemoveEntry(int32 a_Index)
+{
+	const NodeSignatureTable::SignatureId signatureId = m_Entries[a_Index].m_PredictionVertex.m_SignatureId;
+	SignatureEntries& signatureEntries = m_SignatureEntries.FindChecked(signatureId);
+	signatureEntries.m_EntryIndices.RemoveSingleSwap(a_Index);
+	signatureEntries.m_NumUses -= m_Entries[a_Index].m_NumUses;
+	if (signatureEntries.m_EntryIndices.Num() == 0)
+	{
+		m_SignatureEntries.Remove(signatureId);
+		m_SignatureIds.RemoveAt(NodeSignatureTable::LowerBound(m_SignatureIds, signatureId));
+	}
+
+	m_EntryIndex.Remove(EntryKey(m_Entries[a_Index]));
+	const int32 movedIndex = m_Entries.Num() - 1;
+	m_Entries.RemoveAtSwap(a_Index);
+	if (a_Index < m_Entries.Num())
+	{
+		m_EntryIndex.FindChecked(EntryKey(m_Entries[a_Index])) = a_Index;
+		TArray<int32>& movedSignatureEntries = m_SignatureEntries.FindChecked(m_Entries[a_Index].m_PredictionVertex.m_SignatureId).m_EntryIndices;
+		movedSignatureEntries[movedSignatureEntries.Find(movedIndex)] = a_Index;
+	}
+}
+
+void PathPredictionList::RebuildIndex()
+{
+	m_EntryIndex.Empty(m_Entries.Num());
+	m_SignatureIds.Reset();
+	m_SignatureEntries.Empty();
+	for (int32 i = 0; i < m_Entries.Num(); ++i)
+	{
+		m_EntryIndex.Add(EntryKey(m_Entries[i]), i);
+		AddSignatureEntry(m_Entries[i].m_PredictionVertex.m_SignatureId, i);
+	}
+}
+
+void PathPredictionList::AddSignatureEntry(NodeSignatureTable::SignatureId a_SignatureId, int32 a_Index)
+{
+	SignatureEntries* signatureEntries = m_SignatureEntries.Find(a_SignatureId);
+	if (signatureEntries == nullptr)
+	{
+		m_SignatureIds.Insert(a_SignatureId, NodeSignatureTable::LowerBound(m_SignatureIds, a_SignatureId));
+		signatureEntries = &m_SignatureEntries.Add(a_SignatureId);
+	}
+	signatureEntries->m_EntryIndices.Add(a_Index);
+	signatureEntries->m_NumUses += m_Entries[a_Index].m_NumUses;
+}
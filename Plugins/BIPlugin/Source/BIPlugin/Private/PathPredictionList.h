@@ -0,0 +1,56 @@
+#pragma once
+
+#include "PathPredictionEntry.h"
+
+/** All prediction entries stored for a single anchor, indexed on (prediction vertex, context path) so uses can be counted in O(1) */
+class PathPredictionList
+{
+public:
+	struct EntryKey
+	{
+		EntryKey(const PathPredictionEntry& a_Entry);
+		bool operator == (const EntryKey& a_Other) const;
+		friend uint32 GetTypeHash(const EntryKey& a_Instance);
+
+		PathNodeEntry m_PredictionVertex;
+		PathContextPath m_ContextPath;
+	};
+
+	PathPredictionList();
+	~PathPredictionList();
+
+	/** Adds the uses of a_Entry to the matching entry, or stores a_Entry when there is no match yet.
+	 * Negative uses are subtracted, entries left without uses are removed */
+	void AddUses(const PathPredictionEntry& a_Entry);
+	void RemapSignatureIds(const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds);
+
+	const TArray<PathPredictionEntry>& GetEntries() const;
+	int32 Num() const;
+
+	/** Sorted, unique signature ids of the predicted vertices, so they can be intersected with other sorted id sets */
+	const TArray<NodeSignatureTable::SignatureId>& GetSignatureIds() const;
+	/** Indices into GetEntries() of all entries predicting a_SignatureId, or nullptr if it is not predicted */
+	const TArray<int32>* FindEntryIndices(NodeSignatureTable::SignatureId a_SignatureId) const;
+	/** Summed uses of all entries predicting a_SignatureId, kept up to date so it does not need a pass over the entries */
+	int32 GetSignatureUses(NodeSignatureTable::SignatureId a_SignatureId) const;
+
+	friend FArchive& operator << (FArchive& a_Archive, PathPredictionList& a_Value);
+
+private:
+	struct SignatureEntries
+	{
+		SignatureEntries();
+
+		TArray<int32> m_EntryIndices;
+		int32 m_NumUses;
+	};
+
+	void RemoveEntry(int32 a_Index);
+	void RebuildIndex();
+	void AddSignatureEntry(NodeSignatureTable::SignatureId a_SignatureId, int32 a_Index);
+
+	TArray<PathPredictionEntry> m_Entries;
+	TMap<EntryKey, int32> m_EntryIndex;
+	TArray<NodeSignatureTable::SignatureId> m_SignatureIds;
+	TMap<NodeSignatureTable::SignatureId, SignatureEntries> m_SignatureEntries;
+};
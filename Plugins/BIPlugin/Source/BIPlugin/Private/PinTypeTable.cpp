@@ -0,0 +1,109 @@
+#include "BIPluginPrivatePCH.h"
+#include "PinTypeTable.h"
+
+PinTypeTable::PinTypeKey::PinTypeKey()
+{
+}
+
+PinTypeTable::PinTypeKey::PinTypeKey(const FEdGraphPinType& a_PinType)
+	: m_PinCategory(a_PinType.PinCategory)
+	, m_PinSubCategoryObjectPath(a_PinType.PinSubCategoryObject.IsValid() ? 
+		FName(*a_PinType.PinSubCategoryObject->GetPathName()) : NAME_None)
+{
+}
+
+bool PinTypeTable::PinTypeKey::operator ==(const PinTypeKey& a_Other) const
+{
+	return m_PinCategory == a_Other.m_PinCategory && m_PinSubCategoryObjectPath == a_Other.m_PinSubCategoryObjectPath;
+}
+
+uint32 GetTypeHash(const PinTypeTable::PinTypeKey& a_Instance)
+{
+	return GetTypeHash(a_Instance.m_PinCategory) ^ (GetTypeHash(a_Instance.m_PinSubCategoryObjectPath) * 31);
+}
+
+FArchive& operator << (FArchive& a_Archive, PinTypeTable::PinTypeKey& a_Value)
+{
+	//Names are written as strings, name table indices are only meaningful within one session.
+	FString subCategoryObjectPath = a_Value.m_PinSubCategoryObjectPath.ToString();
+	a_Archive << a_Value.m_PinCategory << subCategoryObjectPath;
+	if (a_Archive.IsLoading())
+	{
+		a_Value.m_PinSubCategoryObjectPath = FName(*subCategoryObjectPath);
+	}
+	return a_Archive;
+}
+
+PinTypeTable& PinTypeTable::Get()
+{
+	static PinTypeTable instance;
+	return instance;
+}
+
+PinTypeTable::PinTypeTable()
+{
+	//Interned up front, so the id is known without taking the lock.
+	FEdGraphPinType wildcardPinType;
+	wildcardPinType.PinCategory = UEdGraphSchema_K2::PC_Wildcard;
+	m_WildcardPinType = FindOrAdd(wildcardPinType);
+}
+
+PinTypeTable::~PinTypeTable()
+{
+}
+
+PinTypeTable::PinTypeId PinTypeTable::FindOrAdd(const FEdGraphPinType& a_PinType)
+{
+	return FindOrAdd(PinTypeKey(a_PinType));
+}
+
+PinTypeTable::PinTypeId PinTypeTable::FindOrAdd(const PinTypeKey& a_PinType)
+{
+	FScopeLock lock(&m_Lock);
+	const PinTypeId* existingId = m_PinTypeIds.Find(a_PinType);
+	if (existingId != nullptr)
+	{
+		return *existingId;
+	}
+	const PinTypeId newId = static_cast<PinTypeId>(m_PinTypes.Add(a_PinType));
+	m_PinTypeIds.Add(a_PinType, newId);
+	return newId;
+}
+
+PinTypeTable::PinTypeId PinTypeTable::GetWildcardPinType() const
+{
+	return m_WildcardPinType;
+}
+
+int32 PinTypeTable::Num() const
+{
+	FScopeLock lock(&m_Lock);
+	return m_PinTypeIds.Num();
+}
+
+void PinTypeTable::Serialize(FArchive& a_Archive, TArray<PinTypeId>& a_OutFileToTableIds)
+{
+	int32 numPinTypes = Num();
+	a_Archive << numPinTypes;
+
+	a_OutFileToTableIds.Empty(numPinTypes);
+	for (int32 i = 0; i < numPinTypes; ++i)
+	{
+		if (a_Archive.IsLoading())
+		{
+			PinTypeKey pinType;
+			a_Archive << pinType;
+			a_OutFileToTableIds.Add(FindOrAdd(pinType));
+		}
+		else
+		{
+			PinTypeKey pinType;
+			{
+				FScopeLock lock(&m_Lock);
+				pinType = m_PinTypes[i];
+			}
+			a_Archive << pinType;
+			a_OutFileToTableIds.Add(static_cast<PinTypeId>(i));
+		}
+	}
+}
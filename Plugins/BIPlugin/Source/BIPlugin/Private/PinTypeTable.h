@@ -0,0 +1,44 @@
+#pragma once
+
+#include "EdGraph/EdGraphPin.h"
+
+/** Interns pin types to compact ids, so pin compatibility can be checked without comparing category strings.
+ * Two pin types share an id when their category and sub category object match, the same rule the compatibility filter used. 
+ * Sub category objects are identified by path name, so ids can be persisted without loading the objects. Thread safe. */
+class PinTypeTable
+{
+public:
+	typedef uint32 PinTypeId;
+
+	struct PinTypeKey
+	{
+		PinTypeKey();
+		PinTypeKey(const FEdGraphPinType& a_PinType);
+		bool operator == (const PinTypeKey& a_Other) const;
+		friend uint32 GetTypeHash(const PinTypeKey& a_Instance);
+		friend FArchive& operator << (FArchive& a_Archive, PinTypeKey& a_Value);
+
+		FString m_PinCategory;
+		FName m_PinSubCategoryObjectPath;
+	};
+
+	static PinTypeTable& Get();
+
+	PinTypeTable();
+	~PinTypeTable();
+
+	PinTypeId FindOrAdd(const FEdGraphPinType& a_PinType);
+	PinTypeId FindOrAdd(const PinTypeKey& a_PinType);
+	/** Id of the wildcard pin type, which pins of any type can be connected to */
+	PinTypeId GetWildcardPinType() const;
+	int32 Num() const;
+
+	/** Writes all interned pin types, or reads them back. a_OutFileToTableIds maps the ids stored in the archive to the ids in this table */
+	void Serialize(FArchive& a_Archive, TArray<PinTypeId>& a_OutFileToTableIds);
+
+private:
+	TMap<PinTypeKey, PinTypeId> m_PinTypeIds;
+	TArray<PinTypeKey> m_PinTypes;
+	PinTypeId m_WildcardPinType;
+	mutable FCriticalSection m_Lock;
+};
@@ -2,12 +2,14 @@
 #include "Suggestion.h"
 
 Suggestion::Suggestion()
+	: m_SignatureId(NodeSignatureTable::INVALID_SIGNATURE_ID)
+	, m_SuggestionScoreContext(0.0f)
+	, m_SuggestionScoreUses(0)
 {
 }
 
-Suggestion::Suggestion(const FBlueprintNodeSignature &a_NodeSignature, float a_ContextScore, int32 a_UsesScore)
-	: m_NodeSignature(a_NodeSignature)
-	, m_NodeSignatureGuid(a_NodeSignature.AsGuid())
+Suggestion::Suggestion(NodeSignatureTable::SignatureId a_SignatureId, float a_ContextScore, int32 a_UsesScore)
+	: m_SignatureId(a_SignatureId)
 	, m_SuggestionScoreContext(a_ContextScore)
 	, m_SuggestionScoreUses(a_UsesScore)
 {
@@ -19,17 +21,22 @@ Suggestion::~Suggestion()
 
 bool Suggestion::CompareSignatures(const Suggestion& a_Other) const
 {
-	return a_Other.m_NodeSignatureGuid == m_NodeSignatureGuid;
+	return a_Other.m_SignatureId == m_SignatureId;
 }
 
-const FBlueprintNodeSignature& Suggestion::GetNodeSignature() const
+NodeSignatureTable::SignatureId Suggestion::GetSignatureId() const
 {
-	return m_NodeSignature;
+	return m_SignatureId;
 }
 
-const FGuid& Suggestion::GetNodeSignatureGuid() const
+FBlueprintNodeSignature Suggestion::GetNodeSignature() const
 {
-	return m_NodeSignatureGuid;
+	return NodeSignatureTable::Get().GetSignature(m_SignatureId);
+}
+
+FGuid Suggestion::GetNodeSignatureGuid() const
+{
+	return NodeSignatureTable::Get().GetSignatureGuid(m_SignatureId);
 }
 
 float Suggestion::GetSuggestionContextScore() const
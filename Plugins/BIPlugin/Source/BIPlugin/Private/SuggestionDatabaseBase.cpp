@@ -1,8 +1,16 @@
 #include "BIPluginPrivatePCH.h"
 #include "SuggestionDatabaseBase.h"
+#include "GraphNodeInformationDatabase.h"
+#include "PathGraphSnapshot.h"
 
 namespace
 {
+	TAutoConsoleVariable<int32> CVarFillThreadCount(
+		TEXT("BIPlugin.FillThreadCount"),
+		0,
+		TEXT("Number of threads used to parse blueprints when filling the suggestion database. 0 uses all task graph worker threads, 1 parses serially"),
+		ECVF_Default);
+
 	struct FoldNodeEntry
 	{
 		FoldNodeEntry(UEdGraph* a_Graph, UK2Node* a_Node)
@@ -98,12 +106,25 @@ SuggestionDatabaseBase::~SuggestionDatabaseBase()
 {
 }
 
-void SuggestionDatabaseBase::FillSuggestionDatabase()
+void SuggestionDatabaseBase::ParseBlueprints(const TArray<UBlueprint*>& a_Blueprints)
 {
-	for (TObjectIterator<UBlueprint> BlueprintIt; BlueprintIt; ++BlueprintIt)
+	TArray<PathGraphSnapshot> snapshots;
+	for (UBlueprint* blueprint : a_Blueprints)
 	{
-		UBlueprint* Blueprint = *BlueprintIt;
-		ParseBlueprint(*Blueprint);
+		SnapshotBlueprint(*blueprint, snapshots);
+	}
+	ParseGraphSnapshots(snapshots, GetFillThreadCount());
+}
+
+void SuggestionDatabaseBase::SnapshotBlueprint(const UBlueprint& a_Blueprint, TArray<PathGraphSnapshot>& a_OutSnapshots)
+{
+	const FName blueprintName = GetBlueprintName(&a_Blueprint);
+	TArray<UEdGraph*> graphsInBlueprint;
+	a_Blueprint.GetAllGraphs(graphsInBlueprint);
+	for (UEdGraph* graph : graphsInBlueprint)
+	{
+		RecordNodeInformation(*graph);
+		a_OutSnapshots.Add(PathGraphSnapshot(*graph, blueprintName));
 	}
 }
 
@@ -179,11 +200,22 @@ void SuggestionDatabaseBase::PerformKFoldCrossValidationTest(int32 a_Folds)
 		static_cast<float>(mergedAllResults.m_TestsPerformed));
 }
 
+FName SuggestionDatabaseBase::GetBlueprintName(const UBlueprint* a_Blueprint)
+{
+	return (a_Blueprint != nullptr) ? FName(*a_Blueprint->GetPathName()) : NAME_None;
+}
+
 void SuggestionDatabaseBase::SetGraphNodeDatabase(GraphNodeInformationDatabase* a_Database)
 {
 	m_GraphNodeDatabase = a_Database;
 }
 
+int32 SuggestionDatabaseBase::GetFillThreadCount()
+{
+	const int32 fillThreadCount = CVarFillThreadCount.GetValueOnGameThread();
+	return (fillThreadCount > 0) ? fillThreadCount : FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+}
+
 void SuggestionDatabaseBase::ParseBlueprint(const UBlueprint& a_Blueprint)
 {
 	//const FString onlyParsingBlueprint("SideScrollerExampleMap");
@@ -193,22 +225,27 @@ void SuggestionDatabaseBase::ParseBlueprint(const UBlueprint& a_Blueprint)
 	//	return;
 	//UE_LOG(LogTemp, Warning, TEXT("This is actually a lie. We are only parsing %s"), *onlyParsingBlueprint);
 
+	const FName blueprintName = GetBlueprintName(&a_Blueprint);
 	TArray<UEdGraph*> graphsInBlueprint;
 	a_Blueprint.GetAllGraphs(graphsInBlueprint);
 	for (auto graph : graphsInBlueprint)
 	{
-		ParseGraph(*graph);
+		ParseGraph(*graph, blueprintName);
 	}
 }
 
-void SuggestionDatabaseBase::ParseGraph(const UEdGraph& a_Graph)
+void SuggestionDatabaseBase::ParseGraph(const UEdGraph& a_Graph, FName a_Blueprint)
+{
+	RecordNodeInformation(a_Graph);
+	ParseGraphSnapshot(PathGraphSnapshot(a_Graph, a_Blueprint));
+}
+
+void SuggestionDatabaseBase::RecordNodeInformation(const UEdGraph& a_Graph)
 {
-	TArray<UK2Node*> nodes;
-	a_Graph.GetNodesOfClass(nodes);
-	for (UK2Node* node : nodes)
+	//Databases built outside of the editor module, such as the benchmark's, may have no node information database.
+	if (m_GraphNodeDatabase != nullptr)
 	{
-		ParseNode(*node, EPathDirection::Forward);
-		ParseNode(*node, EPathDirection::Backward);
+		m_GraphNodeDatabase->RecordNodeInformation(a_Graph);
 	}
 }
 
@@ -4,6 +4,9 @@
 #include "Suggestion.h"
 
 class GraphNodeInformationDatabase;
+class PathGraphSnapshot;
+class SuggestionDatabaseSnapshot;
+class SuggestionQuery;
 struct FBlueprintSuggestionContext;
 class SuggestionDatabaseBase
 {
@@ -33,24 +36,70 @@ public:
 		uint32 m_MaxCyclesTaken;
 	};
 
+	typedef TSharedRef<SuggestionQuery, ESPMode::ThreadSafe> SuggestionQueryRef;
+	typedef TSharedRef<SuggestionDatabaseSnapshot, ESPMode::ThreadSafe> SuggestionDatabaseSnapshotRef;
+
 	SuggestionDatabaseBase();
 	virtual ~SuggestionDatabaseBase();
 
-	void FillSuggestionDatabase();
+	/** Parses a_Blueprints. Graphs are snapshotted on the game thread and parsed on BIPlugin.FillThreadCount task graph workers */
+	void ParseBlueprints(const TArray<UBlueprint*>& a_Blueprints);
+	/** Records the node information of a_Blueprint and adds a snapshot of each of its graphs to a_OutSnapshots. Game thread only */
+	void SnapshotBlueprint(const UBlueprint& a_Blueprint, TArray<PathGraphSnapshot>& a_OutSnapshots);
 	virtual void FlushDatabase() = 0;
 	virtual void ProvideSuggestions(const FBlueprintSuggestionContext& a_Context, int32 a_SuggestionCount, TArray<Suggestion>& a_Output) = 0;
+	/** Snapshots the request on the game thread so it can be scored with ExecuteQuery on any thread */
+	virtual SuggestionQueryRef CreateQuery(const FBlueprintSuggestionContext& a_Context, int32 a_SuggestionCount) = 0;
+	/** Scores a query into its results. Safe to run off the game thread, as long as the database is not modified meanwhile */
+	virtual void ExecuteQuery(SuggestionQuery& a_Query) = 0;
 	virtual bool HasSuggestions() const = 0;
+
+	/** Starts building a fresh database off to the side. Queries keep using the current database until FinishRebuild swaps the new one in */
+	virtual void BeginRebuild() = 0;
+	/** Parses a_Snapshots, taken of a_Blueprints with SnapshotBlueprint, into the database that is being rebuilt */
+	virtual void RebuildBlueprints(const TArray<const UBlueprint*>& a_Blueprints, const TArray<PathGraphSnapshot>& a_Snapshots) = 0;
+	/** Replaces the current database with the rebuilt one. No query may be running while this is called */
+	virtual void FinishRebuild() = 0;
+	virtual void CancelRebuild() = 0;
+	virtual bool IsRebuilding() const = 0;
+
+	/** Subtracts what a_Blueprint contributed to the database before, and parses it again */
+	virtual void ReingestBlueprint(const UBlueprint& a_Blueprint) = 0;
 	virtual void GenerateSuggestionForCreatedLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB) = 0;
+	/** Forgets the paths through a link, as GenerateSuggestionForCreatedLink would learn them now. Has to be called while the link still exists */
+	virtual void RemoveSuggestionForBrokenLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB) = 0;
 	virtual CrossValidateResult CrossValidateTest(UEdGraph& a_Graph, const UK2Node& a_Node, int32 a_NumSuggestionsToUse) = 0;
 
 	virtual void Serialize(FArchive& a_Archive) = 0;
+	/** Copies the database so it can be written on a worker thread while this one keeps changing. Clears HasUnsavedChanges */
+	virtual SuggestionDatabaseSnapshotRef CreateSnapshot() = 0;
+	virtual bool HasUnsavedChanges() const = 0;
+	/** Called when a snapshot could not be written, so its changes are saved with the next one */
+	virtual void MarkUnsaved() = 0;
+
+	/** Replays the changes journaled after the loaded database was saved, and journals learned links from now on */
+	virtual void OpenJournal(const FString& a_JournalFilePath) = 0;
+	/** Drops the journaled changes contained in a snapshot that was saved successfully */
+	virtual void CompactJournal(uint64 a_SavedSequence) = 0;
+	virtual bool NeedsJournalCompaction() const = 0;
 
 	void PerformKFoldCrossValidationTest(int32 a_Folds);
 	void SetGraphNodeDatabase(GraphNodeInformationDatabase* a_Database);
 protected:
+	/** Name a blueprint's contributions are recorded under. Stable across editor sessions */
+	static FName GetBlueprintName(const UBlueprint* a_Blueprint);
+	/** Number of threads snapshots are parsed on, set by BIPlugin.FillThreadCount. Game thread only */
+	static int32 GetFillThreadCount();
 	void ParseBlueprint(const UBlueprint& a_Blueprint);
-	void ParseGraph(const UEdGraph& a_Graph);
+	/** Parses a_Graph through a snapshot, so signatures and links are gathered once instead of for every path walk */
+	void ParseGraph(const UEdGraph& a_Graph, FName a_Blueprint);
+	/** Records the pin types of the nodes in a_Graph, so suggestions learned from it can be filtered without template nodes */
+	void RecordNodeInformation(const UEdGraph& a_Graph);
 	virtual void ParseNode(const UK2Node& a_Node, EPathDirection a_Direction) = 0;
+	/** Parses every node of a_Snapshot in both directions on the calling thread */
+	virtual void ParseGraphSnapshot(const PathGraphSnapshot& a_Snapshot) = 0;
+	/** Parses the snapshots on a_NumThreads threads in both directions, as ParseGraph would for the original graphs */
+	virtual void ParseGraphSnapshots(const TArray<PathGraphSnapshot>& a_Snapshots, int32 a_NumThreads) = 0;
 	const GraphNodeInformationDatabase& GetGraphNodeDatabase() const;
 	GraphNodeInformationDatabase& GetGraphNodeDatabase();
 
@@ -0,0 +1,435 @@
+#include "BIPluginPrivatePCH.h"
+#include "SuggestionDatabaseBenchmark.h"
+#include "SuggestionDatabasePath.h"
+#include "SuggestionQuery.h"
+#include "PathGraphSnapshot.h"
+#include "SuggestionDatabaseSnapshot.h"
+
+namespace
+{
+	const int32 BENCHMARK_SUGGESTION_COUNT = 5;
+
+	PathNodeEntry CreateBenchmarkNodeEntry(int32 a_NodeId)
+	{
+		FBlueprintNodeSignature signature(UK2Node_CallFunction::StaticClass());
+		signature.AddKeyValue(FString::Printf(TEXT("BIBenchmarkNode_%i"), a_NodeId));
+		return PathNodeEntry(NodeSignatureTable::Get().FindOrAdd(signature.AsGuid(), signature, 
+			FText::FromString(FString::Printf(TEXT("Benchmark Node %i"), a_NodeId))));
+	}
+
+	PathContextPath CreateBenchmarkContextPath(const TArray<PathNodeEntry>& a_NodePool, int32 a_Seed)
+	{
+		PathContextPath result;
+		for (int32 i = 0; i < PathContextPath::MAX_CONTEXT_PATH_LENGTH; ++i)
+		{
+			result.PushNode(a_NodePool[(a_Seed * 7 + i * 13) % a_NodePool.Num()]);
+		}
+		return result;
+	}
+
+	/** Fills a database with a_NumAnchors anchors, each having a_EntriesPerAnchor distinct predictions */
+	void FillBenchmarkDatabase(SuggestionDatabasePath::PredictionDatabase& a_Database, const TArray<PathNodeEntry>& a_NodePool,
+		int32 a_NumAnchors, int32 a_EntriesPerAnchor)
+	{
+		for (int32 anchor = 0; anchor < a_NumAnchors; ++anchor)
+		{
+			PathNodeEntry anchorEntry = CreateBenchmarkNodeEntry(a_NodePool.Num() + anchor);
+			PathPredictionList& predictions = a_Database.Add(anchorEntry.m_SignatureId);
+			for (int32 i = 0; i < a_EntriesPerAnchor; ++i)
+			{
+				PathPredictionEntry entry;
+				entry.m_Direction = EPathDirection::Forward;
+				entry.m_AnchorVertex = anchorEntry;
+				entry.m_PredictionVertex = a_NodePool[(anchor + i) % a_NodePool.Num()];
+				entry.m_ContextPath = CreateBenchmarkContextPath(a_NodePool, anchor + i);
+				entry.m_NumUses = 1 + (i % 5);
+				predictions.AddUses(entry);
+			}
+		}
+	}
+
+	/** Generates the paths a rebuild would insert, with anchor popularity heavily skewed towards the first few anchors */
+	void CreateSkewedBenchmarkPaths(const TArray<PathNodeEntry>& a_NodePool, int32 a_NumAnchors, int32 a_NumPaths, 
+		TArray<PathPredictionEntry>& a_Output)
+	{
+		FRandomStream random(1337);
+		a_Output.Reserve(a_NumPaths);
+		for (int32 i = 0; i < a_NumPaths; ++i)
+		{
+			const float anchorRoll = random.GetFraction();
+			const int32 anchor = FMath::Min(static_cast<int32>(anchorRoll * anchorRoll * anchorRoll * a_NumAnchors), a_NumAnchors - 1);
+
+			PathPredictionEntry entry;
+			entry.m_Direction = EPathDirection::Forward;
+			entry.m_AnchorVertex = a_NodePool[anchor];
+			entry.m_PredictionVertex = a_NodePool[random.RandHelper(a_NodePool.Num())];
+			entry.m_ContextPath = CreateBenchmarkContextPath(a_NodePool, random.RandHelper(a_NodePool.Num()));
+			entry.m_NumUses = 1;
+			a_Output.Push(entry);
+		}
+	}
+
+	/** Creates graphs where every node is fed by one or two of the nodes placed shortly before it, like typical exec and data chains */
+	void CreateBenchmarkGraphSnapshots(const TArray<PathNodeEntry>& a_NodePool, int32 a_NumGraphs, int32 a_NodesPerGraph, 
+		TArray<PathGraphSnapshot>& a_Output)
+	{
+		const int32 LINK_WINDOW = 8;
+		FRandomStream random(9001);
+		a_Output.Reserve(a_NumGraphs);
+		for (int32 graph = 0; graph < a_NumGraphs; ++graph)
+		{
+			PathGraphSnapshot& snapshot = a_Output[a_Output.Add(PathGraphSnapshot())];
+			for (int32 node = 0; node < a_NodesPerGraph; ++node)
+			{
+				snapshot.AddNode(a_NodePool[random.RandHelper(a_NodePool.Num())].m_SignatureId);
+				const int32 numInputs = (node == 0) ? 0 : 1 + random.RandHelper(2);
+				for (int32 i = 0; i < numInputs; ++i)
+				{
+					snapshot.AddLink(FMath::Max(node - 1 - random.RandHelper(LINK_WINDOW), 0), node);
+				}
+			}
+			snapshot.Finalize();
+		}
+	}
+
+	int32 CountBenchmarkEntries(const SuggestionDatabasePath::PredictionDatabase& a_Database)
+	{
+		int32 result = 0;
+		for (const auto& anchorEntry : a_Database)
+		{
+			result += anchorEntry.Value.Num();
+		}
+		return result;
+	}
+
+	/** The linear scan AddToPredictionDatabase used before the per anchor index, kept as a baseline */
+	void AddToLinearBenchmarkDatabase(TMap<NodeSignatureTable::SignatureId, TArray<PathPredictionEntry>>& a_Database, 
+		const PathPredictionEntry& a_Entry)
+	{
+		TArray<PathPredictionEntry>& predictions = a_Database.FindOrAdd(a_Entry.m_AnchorVertex.m_SignatureId);
+		PathPredictionEntry* match = predictions.FindByPredicate([&](const PathPredictionEntry& obj) -> bool
+		{
+			return obj.CompareExcludingUses(a_Entry);
+		});
+
+		if (match != nullptr)
+		{
+			match->m_NumUses++;
+		}
+		else
+		{
+			predictions.Push(a_Entry);
+		}
+	}
+}
+
+SuggestionDatabaseBenchmark::SuggestionDatabaseBenchmark(SuggestionDatabasePath& a_Database)
+	: m_Database(a_Database)
+{
+}
+
+SuggestionDatabaseBenchmark::~SuggestionDatabaseBenchmark()
+{
+}
+
+void SuggestionDatabaseBenchmark::Run(const TArray<FString>& a_Arguments)
+{
+	const bool runAll = a_Arguments.Num() == 0 || a_Arguments[0].Compare(TEXT("All"), ESearchCase::IgnoreCase) == 0;
+	bool ranBenchmark = false;
+
+	//Benchmarks swap synthetic maps into the database, anchors still waiting in the database file have to be decoded first.
+	m_Database.LoadAllPendingAnchors();
+
+	if (runAll || a_Arguments[0].Compare(TEXT("QueryScaling"), ESearchCase::IgnoreCase) == 0)
+	{
+		BenchmarkQueryScaling();
+		ranBenchmark = true;
+	}
+
+	if (runAll || a_Arguments[0].Compare(TEXT("RebuildSkewed"), ESearchCase::IgnoreCase) == 0)
+	{
+		BenchmarkRebuildSkewed();
+		ranBenchmark = true;
+	}
+
+	if (runAll || a_Arguments[0].Compare(TEXT("TopN"), ESearchCase::IgnoreCase) == 0)
+	{
+		BenchmarkTopNSelection();
+		ranBenchmark = true;
+	}
+
+	if (runAll || a_Arguments[0].Compare(TEXT("ParallelFill"), ESearchCase::IgnoreCase) == 0)
+	{
+		BenchmarkParallelFill();
+		ranBenchmark = true;
+	}
+
+	if (runAll || a_Arguments[0].Compare(TEXT("SnapshotPause"), ESearchCase::IgnoreCase) == 0)
+	{
+		BenchmarkSnapshotPause();
+		ranBenchmark = true;
+	}
+
+	if (!ranBenchmark)
+	{
+		UE_LOG(BILog, Warning, TEXT("Unknown benchmark '%s'. Available benchmarks are: 'All', 'QueryScaling', 'RebuildSkewed', 'TopN', 'ParallelFill', 'SnapshotPause'"), *a_Arguments[0]);
+	}
+}
+
+void SuggestionDatabaseBenchmark::BenchmarkQueryScaling()
+{
+	const int32 NODE_POOL_SIZE = 256;
+	const int32 ENTRIES_PER_ANCHOR = 16;
+	const int32 NUM_QUERIES = 200;
+	const int32 NUM_COPIES = 5;
+	const int32 anchorCounts[] = { 100, 1000, 10000 };
+
+	TArray<PathNodeEntry> nodePool;
+	nodePool.Reserve(NODE_POOL_SIZE);
+	for (int32 i = 0; i < NODE_POOL_SIZE; ++i)
+	{
+		nodePool.Push(CreateBenchmarkNodeEntry(i));
+	}
+
+	TArray<PathContextPath> queryContextPaths;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		queryContextPaths.Push(CreateBenchmarkContextPath(nodePool, i));
+	}
+
+	UE_LOG(BILog, Warning, TEXT("Benchmark QueryScaling: %i entries per anchor, %i queries per run"), ENTRIES_PER_ANCHOR, NUM_QUERIES);
+
+	for (int32 numAnchors : anchorCounts)
+	{
+		//Run on a synthetic database, the live database is swapped back in afterwards.
+		SuggestionDatabasePath::PredictionDatabase benchmarkDatabase;
+		FillBenchmarkDatabase(benchmarkDatabase, nodePool, numAnchors, ENTRIES_PER_ANCHOR);
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), benchmarkDatabase);
+
+		SuggestionQuery query;
+		query.m_AnchorId = CreateBenchmarkNodeEntry(NODE_POOL_SIZE + numAnchors / 2).m_SignatureId;
+		query.m_Direction = EPathDirection::Forward;
+		query.m_ContextPaths = queryContextPaths;
+		query.m_SuggestionCount = BENCHMARK_SUGGESTION_COUNT;
+
+		const uint32 queryStartCycles = FPlatformTime::Cycles();
+		for (int32 i = 0; i < NUM_QUERIES; ++i)
+		{
+			m_Database.ExecuteQuery(query);
+		}
+		const uint32 queryCycles = FPlatformTime::Cycles() - queryStartCycles;
+
+		//For reference; this is what every query used to pay before borrowing the database.
+		const uint32 copyStartCycles = FPlatformTime::Cycles();
+		for (int32 i = 0; i < NUM_COPIES; ++i)
+		{
+			SuggestionDatabasePath::PredictionDatabase copy = m_Database.GetPredictionDatabase(EPathDirection::Forward);
+		}
+		const uint32 copyCycles = FPlatformTime::Cycles() - copyStartCycles;
+
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), benchmarkDatabase);
+
+		UE_LOG(BILog, Warning, TEXT("\t%i anchors (%i entries): %.4f ms per query, %.4f ms per database copy"), numAnchors,
+			numAnchors * ENTRIES_PER_ANCHOR, FPlatformTime::ToMilliseconds(queryCycles) / NUM_QUERIES,
+			FPlatformTime::ToMilliseconds(copyCycles) / NUM_COPIES);
+	}
+}
+
+void SuggestionDatabaseBenchmark::BenchmarkRebuildSkewed()
+{
+	const int32 NODE_POOL_SIZE = 512;
+	const int32 NUM_ANCHORS = 200;
+	const int32 pathCounts[] = { 10000, 50000, 100000 };
+
+	TArray<PathNodeEntry> nodePool;
+	nodePool.Reserve(NODE_POOL_SIZE);
+	for (int32 i = 0; i < NODE_POOL_SIZE; ++i)
+	{
+		nodePool.Push(CreateBenchmarkNodeEntry(i));
+	}
+
+	UE_LOG(BILog, Warning, TEXT("Benchmark RebuildSkewed: %i anchors, cubic popularity skew"), NUM_ANCHORS);
+
+	for (int32 numPaths : pathCounts)
+	{
+		TArray<PathPredictionEntry> paths;
+		CreateSkewedBenchmarkPaths(nodePool, NUM_ANCHORS, numPaths, paths);
+
+		TMap<NodeSignatureTable::SignatureId, TArray<PathPredictionEntry>> linearDatabase;
+		const uint32 linearStartCycles = FPlatformTime::Cycles();
+		for (const PathPredictionEntry& path : paths)
+		{
+			AddToLinearBenchmarkDatabase(linearDatabase, path);
+		}
+		const uint32 linearCycles = FPlatformTime::Cycles() - linearStartCycles;
+
+		SuggestionDatabasePath::PredictionDatabase indexedDatabase;
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), indexedDatabase);
+		const uint32 indexedStartCycles = FPlatformTime::Cycles();
+		for (const PathPredictionEntry& path : paths)
+		{
+			m_Database.AddToPredictionDatabase(path, EPathDirection::Forward);
+		}
+		const uint32 indexedCycles = FPlatformTime::Cycles() - indexedStartCycles;
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), indexedDatabase);
+
+		int32 largestAnchor = 0;
+		for (const auto& anchorEntry : indexedDatabase)
+		{
+			largestAnchor = FMath::Max(largestAnchor, anchorEntry.Value.Num());
+		}
+
+		UE_LOG(BILog, Warning, TEXT("\t%i paths (largest anchor %i distinct paths): linear scan %.2f ms, hash index %.2f ms"), 
+			numPaths, largestAnchor, FPlatformTime::ToMilliseconds(linearCycles), FPlatformTime::ToMilliseconds(indexedCycles));
+	}
+}
+
+void SuggestionDatabaseBenchmark::BenchmarkTopNSelection()
+{
+	const int32 candidateCounts[] = { 10000, 100000, 1000000 };
+	const int32 flagsToTest[] = { ESuggestionFlags::CalculateContext, ESuggestionFlags::SortUsesOverContext };
+
+	UE_LOG(BILog, Warning, TEXT("Benchmark TopN: selecting %i suggestions"), BENCHMARK_SUGGESTION_COUNT);
+
+	for (int32 numCandidates : candidateCounts)
+	{
+		FRandomStream random(4242);
+		TArray<Suggestion> candidates;
+		candidates.Reserve(numCandidates);
+		for (int32 i = 0; i < numCandidates; ++i)
+		{
+			candidates.Push(Suggestion(static_cast<NodeSignatureTable::SignatureId>(i), 
+				static_cast<float>(random.RandHelper(4)) / 3.0f, random.RandHelper(1000)));
+		}
+
+		for (int32 flags : flagsToTest)
+		{
+			//Selecting all candidates degenerates into the full sort that was used before.
+			TArray<Suggestion> fullSortCandidates = candidates;
+			const uint32 fullSortStartCycles = FPlatformTime::Cycles();
+			SuggestionDatabasePath::SelectTopNSuggestions(fullSortCandidates, fullSortCandidates.Num(), flags);
+			fullSortCandidates.SetNum(FMath::Min(fullSortCandidates.Num(), BENCHMARK_SUGGESTION_COUNT), false);
+			const uint32 fullSortCycles = FPlatformTime::Cycles() - fullSortStartCycles;
+
+			TArray<Suggestion> topNCandidates = candidates;
+			const uint32 topNStartCycles = FPlatformTime::Cycles();
+			SuggestionDatabasePath::SelectTopNSuggestions(topNCandidates, BENCHMARK_SUGGESTION_COUNT, flags);
+			const uint32 topNCycles = FPlatformTime::Cycles() - topNStartCycles;
+
+			bool resultsMatch = topNCandidates.Num() == fullSortCandidates.Num();
+			for (int32 i = 0; resultsMatch && i < topNCandidates.Num(); ++i)
+			{
+				resultsMatch = topNCandidates[i].GetSuggestionContextScore() == fullSortCandidates[i].GetSuggestionContextScore() &&
+					topNCandidates[i].GetSuggestionUsesScore() == fullSortCandidates[i].GetSuggestionUsesScore();
+			}
+
+			UE_LOG(BILog, Warning, TEXT("\t%i candidates (%s): full sort %.2f ms, bounded heap %.2f ms, scores match: %s"), 
+				numCandidates, (flags & ESuggestionFlags::SortUsesOverContext) != 0 ? TEXT("UsesOverContext") : TEXT("ContextOverUses"),
+				FPlatformTime::ToMilliseconds(fullSortCycles), FPlatformTime::ToMilliseconds(topNCycles), 
+				resultsMatch ? TEXT("yes") : TEXT("NO"));
+		}
+	}
+}
+
+void SuggestionDatabaseBenchmark::BenchmarkParallelFill()
+{
+	const int32 NODE_POOL_SIZE = 512;
+	const int32 NUM_GRAPHS = 400;
+	const int32 NODES_PER_GRAPH = 150;
+
+	TArray<PathNodeEntry> nodePool;
+	nodePool.Reserve(NODE_POOL_SIZE);
+	for (int32 i = 0; i < NODE_POOL_SIZE; ++i)
+	{
+		nodePool.Push(CreateBenchmarkNodeEntry(i));
+	}
+
+	TArray<PathGraphSnapshot> snapshots;
+	CreateBenchmarkGraphSnapshots(nodePool, NUM_GRAPHS, NODES_PER_GRAPH, snapshots);
+
+	const int32 maxThreads = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+	UE_LOG(BILog, Warning, TEXT("Benchmark ParallelFill: %i graphs of %i nodes, up to %i threads"), NUM_GRAPHS, NODES_PER_GRAPH, maxThreads);
+
+	TArray<int32> threadCounts;
+	for (int32 numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+	{
+		threadCounts.Push(numThreads);
+	}
+	threadCounts.Push(maxThreads);
+
+	float serialMs = 0.0f;
+	int32 serialEntries = 0;
+	for (int32 numThreads : threadCounts)
+	{
+		SuggestionDatabasePath::PredictionDatabase forwardDatabase;
+		SuggestionDatabasePath::PredictionDatabase backwardDatabase;
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), forwardDatabase);
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Backward), backwardDatabase);
+
+		const uint32 startCycles = FPlatformTime::Cycles();
+		m_Database.ParseGraphSnapshots(snapshots, numThreads);
+		const float fillMs = FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startCycles);
+
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), forwardDatabase);
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Backward), backwardDatabase);
+
+		const int32 numEntries = CountBenchmarkEntries(forwardDatabase) + CountBenchmarkEntries(backwardDatabase);
+		if (numThreads == 1)
+		{
+			serialMs = fillMs;
+			serialEntries = numEntries;
+		}
+
+		UE_LOG(BILog, Warning, TEXT("\t%i threads: %.2f ms (%.2fx), %i entries, matches serial: %s"), numThreads, fillMs, 
+			serialMs / FMath::Max(fillMs, KINDA_SMALL_NUMBER), numEntries, numEntries == serialEntries ? TEXT("yes") : TEXT("NO"));
+	}
+}
+
+void SuggestionDatabaseBenchmark::BenchmarkSnapshotPause()
+{
+	const int32 NODE_POOL_SIZE = 256;
+	const int32 ENTRIES_PER_ANCHOR = 16;
+	const int32 anchorCounts[] = { 1000, 10000, 50000 };
+
+	TArray<PathNodeEntry> nodePool;
+	nodePool.Reserve(NODE_POOL_SIZE);
+	for (int32 i = 0; i < NODE_POOL_SIZE; ++i)
+	{
+		nodePool.Push(CreateBenchmarkNodeEntry(i));
+	}
+
+	UE_LOG(BILog, Warning, TEXT("Benchmark SnapshotPause: %i entries per anchor"), ENTRIES_PER_ANCHOR);
+
+	const bool hadUnsavedChanges = m_Database.m_HasUnsavedChanges;
+	for (int32 numAnchors : anchorCounts)
+	{
+		SuggestionDatabasePath::PredictionDatabase benchmarkDatabase;
+		FillBenchmarkDatabase(benchmarkDatabase, nodePool, numAnchors, ENTRIES_PER_ANCHOR);
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), benchmarkDatabase);
+
+		//The game thread only pays for the copy, the write runs on a worker.
+		const uint32 snapshotStartCycles = FPlatformTime::Cycles();
+		SuggestionDatabaseBase::SuggestionDatabaseSnapshotRef snapshot = m_Database.CreateSnapshot();
+		const uint32 snapshotCycles = FPlatformTime::Cycles() - snapshotStartCycles;
+
+		TArray<uint8> snapshotData;
+		FMemoryWriter snapshotWriter(snapshotData);
+		const uint32 writeStartCycles = FPlatformTime::Cycles();
+		snapshot->Serialize(snapshotWriter);
+		const uint32 writeCycles = FPlatformTime::Cycles() - writeStartCycles;
+
+		//For reference; this is what the game thread paid when serializing directly.
+		TArray<uint8> serializeData;
+		FMemoryWriter serializeWriter(serializeData);
+		const uint32 serializeStartCycles = FPlatformTime::Cycles();
+		m_Database.Serialize(serializeWriter);
+		const uint32 serializeCycles = FPlatformTime::Cycles() - serializeStartCycles;
+
+		Exchange(m_Database.GetPredictionDatabase(EPathDirection::Forward), benchmarkDatabase);
+
+		UE_LOG(BILog, Warning, TEXT("\t%i anchors (%i entries, %i KB): snapshot pause %.2f ms, background write %.2f ms, synchronous serialize %.2f ms"), 
+			numAnchors, numAnchors * ENTRIES_PER_ANCHOR, snapshotData.Num() / 1024, FPlatformTime::ToMilliseconds(snapshotCycles), 
+			FPlatformTime::ToMilliseconds(writeCycles), FPlatformTime::ToMilliseconds(serializeCycles));
+	}
+	m_Database.m_HasUnsavedChanges = hadUnsavedChanges;
+}
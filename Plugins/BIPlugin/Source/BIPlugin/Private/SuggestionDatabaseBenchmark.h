@@ -0,0 +1,21 @@
+#pragma once
+
+class SuggestionDatabasePath;
+/** Synthetic benchmarks for the path suggestion database. Run through the BIPlugin_RunBenchmark console command. */
+class SuggestionDatabaseBenchmark
+{
+public:
+	SuggestionDatabaseBenchmark(SuggestionDatabasePath& a_Database);
+	~SuggestionDatabaseBenchmark();
+
+	void Run(const TArray<FString>& a_Arguments);
+
+private:
+	void BenchmarkQueryScaling();
+	void BenchmarkRebuildSkewed();
+	void BenchmarkTopNSelection();
+	void BenchmarkParallelFill();
+	void BenchmarkSnapshotPause();
+
+	SuggestionDatabasePath& m_Database;
+};
@@ -5,11 +5,24 @@
 #include "BlueprintSuggestionContext.h"
 #include "GraphNodeInformationDatabase.h"
 #include "GraphNodeInformation.h"
+#include "NodeSignatureCache.h"
+#include "PathGraphSnapshot.h"
+#include "PathDatabaseFlatFile.h"
+#include "SuggestionDatabaseSnapshot.h"
+#include "PathDatabaseJournal.h"
+#include "Kismet2/BlueprintEditorUtils.h"
 
 #include "StackTimer.h"
+#include "SuggestionQuery.h"
 
 namespace
 {
+	TAutoConsoleVariable<int32> CVarJournalCompactionSizeKB(
+		TEXT("BIPlugin.JournalCompactionSizeKB"),
+		1024,
+		TEXT("Size in KB after which the journal of learned links is compacted by saving a snapshot of the suggestion database"),
+		ECVF_Default);
+
 	EEdGraphPinDirection ToPinDirection(EPathDirection a_PathDirection)
 	{
 		switch (a_PathDirection)
@@ -30,195 +43,659 @@ namespace
 		return Cast<UK2Node>(a_Pin->GetOuter());
 	}
 
-	TArray<UK2Node*> FindNodesInDirection(const UK2Node& a_Node, EPathDirection a_ExploreDirection)
+	/** Walks the links of live graph nodes for PathContextTrie::AddPaths */
+	class LiveGraphPathSource
 	{
-		TArray<UK2Node*> result;
-		for (auto childPin : a_Node.Pins)
+	public:
+		typedef const UK2Node* NodeType;
+
+		struct NeighbourCursor
+		{
+			NodeType m_Node;
+			int32 m_PinIndex;
+			int32 m_LinkIndex;
+		};
+
+		explicit LiveGraphPathSource(EPathDirection a_ExploreDirection)
+			: m_PinDirection(ToPinDirection(a_ExploreDirection))
+		{
+		}
+
+		int32 CountNeighbours(NodeType a_Node) const
 		{
-			if (childPin->Direction == ToPinDirection(a_ExploreDirection) && !childPin->bHidden && 
-				!childPin->bNotConnectable)
+			int32 numNeighbours = 0;
+			for (const UEdGraphPin* pin : a_Node->Pins)
 			{
-				for (auto linkedPin : childPin->LinkedTo)
+				if (pin->Direction == m_PinDirection && !pin->bHidden && !pin->bNotConnectable)
 				{
-					UK2Node* parentNode = GetNodeFromPin(linkedPin);
-					result.Push(parentNode);
+					numNeighbours += pin->LinkedTo.Num();
 				}
 			}
+			return numNeighbours;
 		}
-		return result;
-	}
 
-	void FindPathForNodeRecursive(const UK2Node& a_CurrentNode, EPathDirection a_ExploreDirection, PathPredictionEntry& a_ParentPath, TArray<PathPredictionEntry>& a_Results, int32 a_Depth)
-	{
-		if (a_Depth < PathContextPath::MAX_CONTEXT_PATH_LENGTH)
+		NeighbourCursor GetFirstNeighbour(NodeType a_Node) const
 		{
-			TArray<UK2Node*> children = FindNodesInDirection(a_CurrentNode, a_ExploreDirection);
-			for (UK2Node* child : children)
+			NeighbourCursor cursor;
+			cursor.m_Node = a_Node;
+			cursor.m_PinIndex = 0;
+			cursor.m_LinkIndex = 0;
+			return cursor;
+		}
+
+		/** Every link of a visible pin in the explored direction yields its node, so nodes linked twice are visited twice */
+		bool GetNextNeighbour(NeighbourCursor& a_Cursor, NodeType& a_OutNeighbour) const
+		{
+			const TArray<UEdGraphPin*>& pins = a_Cursor.m_Node->Pins;
+			for (; a_Cursor.m_PinIndex < pins.Num(); ++a_Cursor.m_PinIndex, a_Cursor.m_LinkIndex = 0)
 			{
-				PathPredictionEntry thisPath = PathPredictionEntry(a_ParentPath);
-				thisPath.m_ContextPath.PushNode(PathNodeEntry(*child));
-				a_Results.Push(thisPath);
-				FindPathForNodeRecursive(*child, a_ExploreDirection, thisPath, a_Results, a_Depth + 1);
+				const UEdGraphPin* pin = pins[a_Cursor.m_PinIndex];
+				if (pin->Direction == m_PinDirection && !pin->bHidden && !pin->bNotConnectable && 
+					a_Cursor.m_LinkIndex < pin->LinkedTo.Num())
+				{
+					a_OutNeighbour = GetNodeFromPin(pin->LinkedTo[a_Cursor.m_LinkIndex++]);
+					return true;
+				}
 			}
+			return false;
 		}
-	}
 
-	TArray<PathPredictionEntry> CreatePredictionPathsForNode(const UK2Node& a_Node, EPathDirection a_ExploreDirection)
+		NodeSignatureTable::SignatureId GetSignatureId(NodeType a_Node) const
+		{
+			return NodeSignatureCache::Get().FindOrAdd(*a_Node);
+		}
+
+	private:
+		EEdGraphPinDirection m_PinDirection;
+	};
+
+	/** Walks the links of a PathGraphSnapshot for PathContextTrie::AddPaths, so paths can be found off the game thread */
+	class SnapshotPathSource
 	{
-		TArray<PathPredictionEntry> result;
-		PathPredictionEntry initialNode;
-		initialNode.m_Direction = a_ExploreDirection;
-		initialNode.m_PredictionVertex = PathNodeEntry(a_Node);
+	public:
+		typedef int32 NodeType;
+
+		struct NeighbourCursor
+		{
+			const int32* m_Neighbours;
+			int32 m_NumNeighbours;
+			int32 m_Index;
+		};
+
+		SnapshotPathSource(const PathGraphSnapshot& a_Snapshot, EPathDirection a_ExploreDirection)
+			: m_Snapshot(a_Snapshot)
+			, m_ExploreDirection(a_ExploreDirection)
+		{
+		}
+
+		int32 CountNeighbours(NodeType a_Node) const
+		{
+			int32 numNeighbours = 0;
+			m_Snapshot.GetNeighbours(a_Node, m_ExploreDirection, numNeighbours);
+			return numNeighbours;
+		}
+
+		NeighbourCursor GetFirstNeighbour(NodeType a_Node) const
+		{
+			NeighbourCursor cursor;
+			cursor.m_Neighbours = m_Snapshot.GetNeighbours(a_Node, m_ExploreDirection, cursor.m_NumNeighbours);
+			cursor.m_Index = 0;
+			return cursor;
+		}
+
+		bool GetNextNeighbour(NeighbourCursor& a_Cursor, NodeType& a_OutNeighbour) const
+		{
+			if (a_Cursor.m_Index < a_Cursor.m_NumNeighbours)
+			{
+				a_OutNeighbour = a_Cursor.m_Neighbours[a_Cursor.m_Index++];
+				return true;
+			}
+			return false;
+		}
 
-		for (const auto node : FindNodesInDirection(a_Node, a_ExploreDirection))
+		NodeSignatureTable::SignatureId GetSignatureId(NodeType a_Node) const
+		{
+			return m_Snapshot.GetSignatureId(a_Node);
+		}
+
+	private:
+		const PathGraphSnapshot& m_Snapshot;
+		EPathDirection m_ExploreDirection;
+	};
+
+	/** Path walk settings, read on the game thread so walks on other threads use the same ones */
+	struct PathWalkLimits
+	{
+		PathWalkLimits()
+			: m_ContextLength(PathContextTrie::GetConfiguredContextLength())
+			, m_MaxPaths(PathContextTrie::GetConfiguredPathBudget())
 		{
-			PathPredictionEntry pathEntry = PathPredictionEntry(initialNode);
-			pathEntry.m_AnchorVertex = PathNodeEntry(*node);
-			pathEntry.m_NumUses = 1;
-			result.Push(pathEntry);
-			FindPathForNodeRecursive(*node, a_ExploreDirection, pathEntry, result, 0);
 		}
 
-		return result;
+		int32 m_ContextLength;
+		int32 m_MaxPaths;
+	};
+
+	/** Fills a_Trie with the prediction paths of a_Node: the first node of every path is an anchor, the nodes after it its context */
+	template <typename PATH_SOURCE>
+	void FindPredictionPaths(const PATH_SOURCE& a_Source, typename PATH_SOURCE::NodeType a_Node, const PathWalkLimits& a_Limits, 
+		PathContextTrie& a_Trie)
+	{
+		a_Trie.Reset();
+		a_Trie.AddPaths(a_Source, a_Node, a_Limits.m_ContextLength + 1, a_Limits.m_MaxPaths);
+	}
+
+	/** Calls a_Visitor with the prediction entry of every path FindPredictionPaths put into a_Trie. The entry is reused between calls */
+	template <typename VISITOR>
+	void ForEachPredictionEntry(const PathContextTrie& a_Trie, NodeSignatureTable::SignatureId a_PredictionId, 
+		EPathDirection a_ExploreDirection, VISITOR a_Visitor)
+	{
+		PathPredictionEntry entry;
+		entry.m_Direction = a_ExploreDirection;
+		entry.m_PredictionVertex = PathNodeEntry(a_PredictionId);
+		entry.m_NumUses = 1;
+		for (PathContextTrie::PathIndex path = PathContextTrie::ROOT_PATH + 1; path < a_Trie.Num(); ++path)
+		{
+			entry.m_AnchorVertex = PathNodeEntry(a_Trie.GetLastSignatureId(a_Trie.GetPrefix(path, 1)));
+			a_Trie.GetPath(path, 1, entry.m_ContextPath);
+			a_Visitor(entry);
+		}
 	}
 
-	void FindAllContextPathsRecursive(const UK2Node& a_Node, EPathDirection a_ExploreDirection, int32 a_Depth, 
-		PathContextPath& a_CurrentPath, TArray<PathContextPath>& a_Results)
+	/** Partial prediction databases filled by a single thread, merged into the real database afterwards */
+	struct PredictionDatabaseShard
 	{
-		if (a_Depth < PathContextPath::MAX_CONTEXT_PATH_LENGTH)
+		SuggestionDatabasePath::ContributionMap m_Contributions; //Paths are kept per blueprint so they can be attributed when merging
+		PathWalkLimits m_Limits;
+		PathContextTrie::WalkStats m_WalkStats;
+	};
+
+	void ParseSnapshotsIntoShard(const TArray<PathGraphSnapshot>& a_Snapshots, FThreadSafeCounter& a_NextSnapshot, PredictionDatabaseShard& a_Shard)
+	{
+		const EPathDirection directions[] = { EPathDirection::Forward, EPathDirection::Backward };
+
+		//Snapshots are handed out one at a time, so threads that get small graphs pick up more of them.
+		PathContextTrie predictionPaths;
+		for (int32 snapshotIndex = a_NextSnapshot.Increment() - 1; snapshotIndex < a_Snapshots.Num(); 
+			snapshotIndex = a_NextSnapshot.Increment() - 1)
 		{
-			TArray<UK2Node*> children = FindNodesInDirection(a_Node, a_ExploreDirection);
-			if (children.Num() > 0)
+			const PathGraphSnapshot& snapshot = a_Snapshots[snapshotIndex];
+			BlueprintContribution& contribution = a_Shard.m_Contributions.FindOrAdd(snapshot.GetBlueprint());
+			for (int32 node = 0; node < snapshot.Num(); ++node)
 			{
-				for (UK2Node* child : children)
+				for (EPathDirection direction : directions)
 				{
-					PathContextPath childPath = PathContextPath(a_CurrentPath);
-					childPath.PushNode(PathNodeEntry(*child));
-					FindAllContextPathsRecursive(*child, a_ExploreDirection, a_Depth + 1, childPath, a_Results);
+					FindPredictionPaths(SnapshotPathSource(snapshot, direction), node, a_Shard.m_Limits, predictionPaths);
+					ForEachPredictionEntry(predictionPaths, snapshot.GetSignatureId(node), direction, 
+						[&contribution](const PathPredictionEntry& a_Entry)
+						{
+							contribution.AddUses(a_Entry);
+						});
 				}
 			}
-			else
+		}
+		a_Shard.m_WalkStats.Add(predictionPaths.GetStats());
+	}
+
+	class ParseSnapshotsShardTask
+	{
+	public:
+		ParseSnapshotsShardTask(const TArray<PathGraphSnapshot>& a_Snapshots, FThreadSafeCounter& a_NextSnapshot, PredictionDatabaseShard& a_Shard)
+			: m_Snapshots(a_Snapshots)
+			, m_NextSnapshot(a_NextSnapshot)
+			, m_Shard(a_Shard)
+		{
+		}
+
+		FORCEINLINE TStatId GetStatId() const
+		{
+			RETURN_QUICK_DECLARE_CYCLE_STAT(ParseSnapshotsShardTask, STATGROUP_TaskGraphTasks);
+		}
+
+		static ENamedThreads::Type GetDesiredThread()
+		{
+			return ENamedThreads::AnyThread;
+		}
+
+		static ESubsequentsMode::Type GetSubsequentsMode()
+		{
+			return ESubsequentsMode::TrackSubsequents;
+		}
+
+		void DoTask(ENamedThreads::Type a_CurrentThread, const FGraphEventRef& a_CompletionGraphEvent)
+		{
+			ParseSnapshotsIntoShard(m_Snapshots, m_NextSnapshot, m_Shard);
+		}
+
+	private:
+		const TArray<PathGraphSnapshot>& m_Snapshots;
+		FThreadSafeCounter& m_NextSnapshot;
+		PredictionDatabaseShard& m_Shard;
+	};
+
+	/** The context paths of a query are the longest paths leaving a_Node, or the empty path if nothing is linked */
+	void FindAllContextPaths(const UK2Node& a_Node, EPathDirection a_ExploreDirection, PathContextTrie& a_Trie, 
+		TArray<PathContextPath>& a_OutContextPaths)
+	{
+		const PathWalkLimits limits;
+		a_Trie.Reset();
+		a_Trie.AddPaths(LiveGraphPathSource(a_ExploreDirection), &a_Node, limits.m_ContextLength, limits.m_MaxPaths);
+
+		a_OutContextPaths.Reset();
+		for (PathContextTrie::PathIndex path = PathContextTrie::ROOT_PATH; path < a_Trie.Num(); ++path)
+		{
+			if (a_Trie.IsLeaf(path))
 			{
-				a_Results.Push(a_CurrentPath);
+				a_Trie.GetPath(path, 0, a_OutContextPaths[a_OutContextPaths.AddDefaulted()]);
 			}
 		}
-		else
+	}
+
+	bool IsCompatibleWithConnectingPin(const PathNodeEntry& a_SuggestedNode, const SuggestionQuery& a_Query, 
+		const GraphNodeInformationDatabase& a_NodeInfoDatabase)
+	{
+		//Runs off the game thread, so only information that was resolved when the query was created can be used.
+		const GraphNodeInformation* suggestionNodeInfo = a_NodeInfoDatabase.FindNodeInformation(a_SuggestedNode.GetSignatureGuid());
+		//PHILTODO: This looks weird. We could not retrieve information about the suggested node. 
+		if (suggestionNodeInfo == nullptr)
 		{
-			a_Results.Push(a_CurrentPath);
+			UE_LOG(BILog, BI_VERBOSE, TEXT("Got no information about suggested node %s in graph %s"), 
+				*(a_SuggestedNode.GetTitle().ToString()), *a_Query.m_ContextGraphName);
+			return false;
 		}
+
+		EEdGraphPinDirection otherPinDirection = UEdGraphPin::GetComplementaryDirection(a_Query.m_ConnectingPinDirection);
+		return suggestionNodeInfo->AcceptsPinTypeInDirection(a_Query.m_ConnectingPinType, otherPinDirection);
 	}
 
-	TArray<PathContextPath> FindAllContextPaths(const UK2Node& a_Node, EPathDirection a_ExploreDirection)
+	struct SuggestionNodeSortingContextOverUses
 	{
-		TArray<PathContextPath> result;
-		PathContextPath initialPath;
-		FindAllContextPathsRecursive(a_Node, a_ExploreDirection, 0, initialPath, result);		
-		return result;
-	}
+		inline bool operator() (const Suggestion& lhs, const Suggestion& rhs) const
+		{
+			return lhs.GetSuggestionContextScore() > rhs.GetSuggestionContextScore() || 
+				(lhs.GetSuggestionContextScore() == rhs.GetSuggestionContextScore() && 
+				lhs.GetSuggestionUsesScore() > rhs.GetSuggestionUsesScore());
+		}
+	};
 
-	void FilterSuggestionsUsingContextPaths(const TArray<PathPredictionEntry>& a_AvailableSuggestionPaths, const TArray<PathContextPath>& a_AvailableContextPaths, TArray<Suggestion>& a_Output, int32 a_Flags)
+	struct SuggestionNodeSortingUsesOverContext
 	{
-		for (const PathPredictionEntry& entry : a_AvailableSuggestionPaths)
+		inline bool operator() (const Suggestion& lhs, const Suggestion& rhs) const
+		{
+			return lhs.GetSuggestionUsesScore() > rhs.GetSuggestionUsesScore() ||
+				(lhs.GetSuggestionUsesScore() == rhs.GetSuggestionUsesScore() &&
+				lhs.GetSuggestionContextScore() > rhs.GetSuggestionContextScore());
+		}
+	};
+
+	/** Inverts a sorting predicate so the heap keeps the worst selected suggestion on top */
+	template <typename SORT_PREDICATE>
+	struct SuggestionHeapPredicate
+	{
+		SuggestionHeapPredicate(const SORT_PREDICATE& a_SortPredicate)
+			: m_SortPredicate(a_SortPredicate)
 		{
-			for (const PathContextPath& context : a_AvailableContextPaths)
-			{
-				float contextSimilarity = ((a_Flags & ESuggestionFlags::CalculateContext) != 0) ? 
-					context.CompareContext(entry.m_ContextPath) : 0.0f;
-				
-				Suggestion suggest(entry.m_PredictionVertex.m_NodeSignature, contextSimilarity, entry.m_NumUses);
-				a_Output.Push(suggest);
-			}
 		}
-	}
 
-	void CombineSuggestions(TArray<Suggestion>& a_InOutSuggestions)
+		inline bool operator() (const Suggestion& lhs, const Suggestion& rhs) const
+		{
+			return m_SortPredicate(rhs, lhs);
+		}
+
+		const SORT_PREDICATE& m_SortPredicate;
+	};
+
+	/** Keeps the best a_MaxSuggestionCount of the suggestions added to it in a bounded heap, O(log k) per suggestion */
+	template <typename SORT_PREDICATE>
+	class TopSuggestionSelector
 	{
-		TArray<Suggestion> collapsedSuggestions;
-		for (Suggestion suggested : a_InOutSuggestions)
+	public:
+		TopSuggestionSelector(int32 a_MaxSuggestionCount, const SORT_PREDICATE& a_SortPredicate)
+			: m_MaxSuggestionCount(a_MaxSuggestionCount)
+			, m_SortPredicate(a_SortPredicate)
+			, m_HeapPredicate(a_SortPredicate)
+		{
+			m_Selected.Reserve(FMath::Max(a_MaxSuggestionCount, 0) + 1);
+		}
+
+		/** Whether a_Suggestion would be selected if it was added now. Stays false once it is, as selections only get better */
+		bool WouldSelect(const Suggestion& a_Suggestion)
 		{
-			Suggestion* containedSuggestion = collapsedSuggestions.FindByPredicate([&](const Suggestion& a_Suggestion) {
-				return a_Suggestion.CompareSignatures(suggested);
-			}); 
-			if (containedSuggestion != nullptr)
+			return m_Selected.Num() < m_MaxSuggestionCount || 
+				(m_MaxSuggestionCount > 0 && m_SortPredicate(a_Suggestion, m_Selected.HeapTop()));
+		}
+
+		void Add(const Suggestion& a_Suggestion)
+		{
+			if (m_Selected.Num() < m_MaxSuggestionCount)
 			{
-				containedSuggestion->SetSuggestionContextScore(FMath::Max(suggested.GetSuggestionContextScore(), 
-					containedSuggestion->GetSuggestionContextScore()));
-				containedSuggestion->SetSuggestionUsesScore(containedSuggestion->GetSuggestionUsesScore() + 
-					suggested.GetSuggestionUsesScore());
+				m_Selected.HeapPush(a_Suggestion, m_HeapPredicate);
 			}
-			else
+			else if (WouldSelect(a_Suggestion))
 			{
-				collapsedSuggestions.Add(suggested);
+				Suggestion worstSelected;
+				m_Selected.HeapPop(worstSelected, m_HeapPredicate);
+				m_Selected.HeapPush(a_Suggestion, m_HeapPredicate);
 			}
 		}
 
-		a_InOutSuggestions = collapsedSuggestions;
+		/** Moves the selected suggestions into a_Output, sorted best first */
+		void MoveSelected(TArray<Suggestion>& a_Output)
+		{
+			m_Selected.Sort(m_SortPredicate);
+			Exchange(a_Output, m_Selected);
+			m_Selected.Reset();
+		}
+
+	private:
+		int32 m_MaxSuggestionCount;
+		const SORT_PREDICATE& m_SortPredicate;
+		SuggestionHeapPredicate<SORT_PREDICATE> m_HeapPredicate;
+		TArray<Suggestion> m_Selected;
+	};
+
+	/** Selects the best a_MaxSuggestionCount suggestions in O(n log k) using a bounded heap, result is sorted best first */
+	template <typename SORT_PREDICATE>
+	void SelectTopNSuggestionsUsingPredicate(TArray<Suggestion>& a_InOutSuggestions, int32 a_MaxSuggestionCount, const SORT_PREDICATE& a_SortPredicate)
+	{
+		if (a_InOutSuggestions.Num() <= a_MaxSuggestionCount)
+		{
+			a_InOutSuggestions.Sort(a_SortPredicate);
+			return;
+		}
+
+		TopSuggestionSelector<SORT_PREDICATE> selector(a_MaxSuggestionCount, a_SortPredicate);
+		for (const Suggestion& suggested : a_InOutSuggestions)
+		{
+			selector.Add(suggested);
+		}
+		selector.MoveSelected(a_InOutSuggestions);
 	}
 
-	TArray<PathPredictionEntry> RemoveIncompatibleSuggestionsBasedOnConnectablePinTypes(const TArray<PathPredictionEntry>& a_AvailableSuggestions, const UEdGraphPin& a_ConnectingPin, GraphNodeInformationDatabase& a_NodeInfoDatabase, UEdGraph* a_ContextGraph)
+	/** A signature that may be suggested, with the summed uses of all its entries */
+	struct SuggestionCandidate
 	{
-		TArray<PathPredictionEntry> result;
-		result.Reserve(a_AvailableSuggestions.Num());
+		NodeSignatureTable::SignatureId m_SignatureId;
+		int32 m_NumUses;
+	};
 
-		for (PathPredictionEntry entry : a_AvailableSuggestions)
+	struct SuggestionCandidateSortingMostUsed
+	{
+		inline bool operator() (const SuggestionCandidate& lhs, const SuggestionCandidate& rhs) const
 		{
-			const GraphNodeInformation* suggestionNodeInfo = a_NodeInfoDatabase.FindNodeInformation(
-				entry.m_PredictionVertex.m_NodeSignatureGuid, a_ContextGraph);
-			//PHILTODO: This looks weird. We could not retrieve information about the suggested node. 
-			if (suggestionNodeInfo != nullptr)
+			return lhs.m_NumUses > rhs.m_NumUses || (lhs.m_NumUses == rhs.m_NumUses && lhs.m_SignatureId < rhs.m_SignatureId);
+		}
+	};
+
+	/** Scores a_Candidates, which are sorted most used first, into the best a_Query.m_SuggestionCount suggestions.
+	 * No candidate can score better than a perfect context match with its uses, so scoring stops at the first candidate whose
+	 * bound cannot beat the worst selected suggestion; the candidates after it have no more uses. Returns false if cancelled */
+	template <typename SORT_PREDICATE>
+	bool ScoreCandidates(const TArray<SuggestionCandidate>& a_Candidates, const PathPredictionList& a_Predictions, 
+		bool a_CalculateContext, int32 a_UsesMultiplier, SuggestionQuery& a_Query, const SORT_PREDICATE& a_SortPredicate)
+	{
+		const int32 CANCEL_CHECK_INTERVAL = 256;
+		const float MAX_CONTEXT_SIMILARITY = 1.0f;
+		const TArray<PathContextPath>& contextPaths = a_Query.m_ContextPaths;
+		const TArray<PathPredictionEntry>& entries = a_Predictions.GetEntries();
+
+		TopSuggestionSelector<SORT_PREDICATE> selector(a_Query.m_SuggestionCount, a_SortPredicate);
+		int32 numScoredCandidates = 0;
+		int32 numVisited = 0;
+		for (const SuggestionCandidate& candidate : a_Candidates)
+		{
+			const int32 usesScore = candidate.m_NumUses * a_UsesMultiplier;
+			if (!selector.WouldSelect(Suggestion(candidate.m_SignatureId, a_CalculateContext ? MAX_CONTEXT_SIMILARITY : 0.0f, usesScore)))
+			{
+				break;
+			}
+
+			float contextSimilarity = 0.0f;
+			if (a_CalculateContext)
 			{
-				EEdGraphPinDirection otherPinDirection = UEdGraphPin::GetComplementaryDirection(
-					a_ConnectingPin.Direction);
-				if (suggestionNodeInfo->HasPinTypeInDirection(a_ConnectingPin.PinType, otherPinDirection))
+				for (int32 entryIndex : *a_Predictions.FindEntryIndices(candidate.m_SignatureId))
 				{
-					result.Push(entry);
+					if (numVisited++ % CANCEL_CHECK_INTERVAL == 0 && a_Query.IsCancelled())
+					{
+						return false;
+					}
+
+					for (const PathContextPath& context : contextPaths)
+					{
+						contextSimilarity = FMath::Max(contextSimilarity, context.CompareContext(entries[entryIndex].m_ContextPath));
+					}
+					if (contextSimilarity >= MAX_CONTEXT_SIMILARITY)
+					{
+						break;
+					}
 				}
 			}
-			else
+			else if (numVisited++ % CANCEL_CHECK_INTERVAL == 0 && a_Query.IsCancelled())
 			{
-				UE_LOG(BILog, BI_VERBOSE, TEXT("Got no information about suggested node %s in graph %s"), 
-					*(entry.m_PredictionVertex.m_NodeTitle.ToString()), *(a_ContextGraph->GetName()));
+				return false;
 			}
+
+			selector.Add(Suggestion(candidate.m_SignatureId, contextSimilarity, usesScore));
+			++numScoredCandidates;
 		}
 
-		return result;
+		UE_LOG(BILog, BI_VERBOSE, TEXT("Scored %i of %i candidates"), numScoredCandidates, a_Candidates.Num());
+		selector.MoveSelected(a_Query.m_Results);
+		return true;
+	}
+
+	void RemapSignatureIds(SuggestionDatabasePath::PredictionDatabase& a_Database, const TArray<NodeSignatureTable::SignatureId>& a_FileToTableIds)
+	{
+		SuggestionDatabasePath::PredictionDatabase remappedDatabase;
+		for (auto& anchorEntry : a_Database)
+		{
+			anchorEntry.Value.RemapSignatureIds(a_FileToTableIds);
+			Exchange(remappedDatabase.Add(a_FileToTableIds[anchorEntry.Key]), anchorEntry.Value);
+		}
+		Exchange(a_Database, remappedDatabase);
 	}
 
-	void SelectTopNSuggestions(TArray<Suggestion>& a_InOutSuggestions, int32 a_MaxSuggestionCount, int32 a_Flags)
+	/** Adds the uses of a_Delta to a_Database, anchors left without entries are removed */
+	void AddUsesToDatabase(SuggestionDatabasePath::PredictionDatabase& a_Database, const PathPredictionEntry& a_Delta)
 	{
-		struct SuggestionNodeSortingContextOverUses
+		if (a_Delta.m_NumUses > 0)
+		{
+			a_Database.FindOrAdd(a_Delta.m_AnchorVertex.m_SignatureId).AddUses(a_Delta);
+			return;
+		}
+
+		PathPredictionList* predictionList = a_Database.Find(a_Delta.m_AnchorVertex.m_SignatureId);
+		if (predictionList != nullptr)
 		{
-			inline bool operator() (const Suggestion& lhs, const Suggestion& rhs) const
+			predictionList->AddUses(a_Delta);
+			if (predictionList->Num() == 0)
 			{
-				return lhs.GetSuggestionContextScore() > rhs.GetSuggestionContextScore() || 
-					(lhs.GetSuggestionContextScore() == rhs.GetSuggestionContextScore() && 
-					lhs.GetSuggestionUsesScore() > rhs.GetSuggestionUsesScore());
+				a_Database.Remove(a_Delta.m_AnchorVertex.m_SignatureId);
 			}
-		};
+		}
+	}
 
-		struct SuggestionNodeSortingUsesOverContext
+	/** The signature ids are those of the flat file written after the contributions, which writes table ids as file ids */
+	void SerializeContributions(FArchive& a_Archive, SuggestionDatabasePath::ContributionMap& a_Contributions)
+	{
+		int32 numBlueprints = a_Contributions.Num();
+		a_Archive << numBlueprints;
+		if (a_Archive.IsLoading())
 		{
-			inline bool operator() (const Suggestion& lhs, const Suggestion& rhs) const
+			if (numBlueprints < 0 || numBlueprints > a_Archive.TotalSize())
 			{
-				return lhs.GetSuggestionUsesScore() > rhs.GetSuggestionUsesScore() ||
-					(lhs.GetSuggestionUsesScore() == rhs.GetSuggestionUsesScore() &&
-					lhs.GetSuggestionContextScore() > rhs.GetSuggestionContextScore());
+				a_Archive.ArIsError = true;
+				return;
 			}
-		};
+			a_Contributions.Empty(numBlueprints);
+			for (int32 i = 0; i < numBlueprints && !a_Archive.IsError(); ++i)
+			{
+				FString blueprintName;
+				a_Archive << blueprintName;
+				a_Archive << a_Contributions.Add(FName(*blueprintName));
+			}
+		}
+		else
+		{
+			for (auto& contribution : a_Contributions)
+			{
+				FString blueprintName = contribution.Key.ToString();
+				a_Archive << blueprintName << contribution.Value;
+			}
+		}
+	}
 
-		if ((a_Flags & ESuggestionFlags::SortUsesOverContext) != 0)
+	/** Reads VERSION_0_5 and 0_6 contributions, which stored a copy of the signature table and a prediction database per direction */
+	void DeserializeLegacyContributions(FArchive& a_Archive, SuggestionDatabasePath::ContributionMap& a_Contributions)
+	{
+		TArray<NodeSignatureTable::SignatureId> fileToTableIds;
+		NodeSignatureTable::Get().Serialize(a_Archive, fileToTableIds);
+
+		int32 numBlueprints = 0;
+		a_Archive << numBlueprints;
+		a_Contributions.Empty(numBlueprints);
+		for (int32 i = 0; i < numBlueprints; ++i)
 		{
-			a_InOutSuggestions.Sort(SuggestionNodeSortingUsesOverContext());
+			FString blueprintName;
+			SuggestionDatabasePath::PredictionDatabase databases[2];
+			a_Archive << blueprintName << databases[0] << databases[1];
+
+			BlueprintContribution& contribution = a_Contributions.Add(FName(*blueprintName));
+			for (SuggestionDatabasePath::PredictionDatabase& database : databases)
+			{
+				RemapSignatureIds(database, fileToTableIds);
+				for (const auto& anchorEntry : database)
+				{
+					for (const PathPredictionEntry& entry : anchorEntry.Value.GetEntries())
+					{
+						contribution.AddUses(entry);
+					}
+				}
+			}
 		}
-		else
+	}
+
+	/** Returns false if a_Pending is malformed, a_OutContributions is left empty then */
+	bool DecodeContributions(const SuggestionDatabasePath::PendingContributions& a_Pending, SuggestionDatabasePath::ContributionMap& a_OutContributions)
+	{
+		FMemoryReader contributionReader(a_Pending.m_Data);
+		SerializeContributions(contributionReader, a_OutContributions);
+		if (contributionReader.IsError())
 		{
-			a_InOutSuggestions.Sort(SuggestionNodeSortingContextOverUses());
+			a_OutContributions.Empty();
+			return false;
 		}
 
-		if (a_InOutSuggestions.Num() > a_MaxSuggestionCount)
+		for (auto& contribution : a_OutContributions)
 		{
-			a_InOutSuggestions.SetNum(a_MaxSuggestionCount, true);
-			a_InOutSuggestions.Shrink();
+			contribution.Value.RemapSignatureIds(a_Pending.m_FileToTableIds);
+		}
+		return true;
+	}
+
+	/** Encodes a_Contributions, or the contributions in a_Pending if they were never decoded. Those still refer to the ids of the loaded file,
+	 * which are translated to the table ids the new file is written with. a_InOutHasUnattributedUses is set if a_Pending is malformed */
+	TArray<uint8> EncodeContributions(SuggestionDatabasePath::ContributionMap& a_Contributions, 
+		const SuggestionDatabasePath::PendingContributionsPtr& a_Pending, bool& a_InOutHasUnattributedUses)
+	{
+		SuggestionDatabasePath::ContributionMap pendingContributions;
+		if (a_Pending.IsValid() && !DecodeContributions(*a_Pending, pendingContributions))
+		{
+			a_InOutHasUnattributedUses = true;
+		}
+
+		TArray<uint8> contributionData;
+		FMemoryWriter contributionWriter(contributionData);
+		SerializeContributions(contributionWriter, a_Pending.IsValid() ? pendingContributions : a_Contributions);
+		return contributionData;
+	}
+
+	void WriteDatabaseFile(FArchive& a_Archive, const SuggestionDatabasePath::PredictionDatabase& a_ForwardDatabase, 
+		const SuggestionDatabasePath::PredictionDatabase& a_BackwardDatabase, const PathDatabaseFlatFile* a_PendingAnchors, 
+		TArray<uint8>& a_ContributionData, bool a_HasUnattributedUses, uint64 a_JournalSequence)
+	{
+		int32 fileVersion = (int32)EDatabasePathSerializeVersion::VERSION_LATEST;
+		a_Archive << fileVersion;
+		a_Archive << a_JournalSequence;
+		a_Archive << a_HasUnattributedUses;
+		a_Archive << a_ContributionData;
+		PathDatabaseFlatFile::Write(a_Archive, a_ForwardDatabase, a_BackwardDatabase, a_PendingAnchors);
+	}
+
+	class PathDatabaseSnapshot : public SuggestionDatabaseSnapshot
+	{
+	public:
+		PathDatabaseSnapshot(const SuggestionDatabasePath::PredictionDatabase& a_ForwardDatabase, 
+			const SuggestionDatabasePath::PredictionDatabase& a_BackwardDatabase, const TSharedPtr<PathDatabaseFlatFile>& a_PendingAnchors,
+			const SuggestionDatabasePath::ContributionMap& a_Contributions, const SuggestionDatabasePath::PendingContributionsPtr& a_PendingContributions, 
+			bool a_HasUnattributedUses, uint64 a_JournalSequence)
+			: SuggestionDatabaseSnapshot(a_JournalSequence)
+			, m_ForwardPredictionDatabase(a_ForwardDatabase)
+			, m_BackwardPredictionDatabase(a_BackwardDatabase)
+			, m_PendingAnchors(a_PendingAnchors)
+			, m_Contributions(a_Contributions)
+			, m_PendingContributions(a_PendingContributions)
+			, m_HasUnattributedUses(a_HasUnattributedUses)
+		{
+		}
+
+		virtual void Serialize(FArchive& a_Archive) override
+		{
+			bool hasUnattributedUses = m_HasUnattributedUses;
+			TArray<uint8> contributionData = EncodeContributions(m_Contributions, m_PendingContributions, hasUnattributedUses);
+			WriteDatabaseFile(a_Archive, m_ForwardPredictionDatabase, m_BackwardPredictionDatabase, m_PendingAnchors.Get(), contributionData, 
+				hasUnattributedUses, GetJournalSequence());
+		}
+
+	private:
+		const SuggestionDatabasePath::PredictionDatabase m_ForwardPredictionDatabase;
+		const SuggestionDatabasePath::PredictionDatabase m_BackwardPredictionDatabase;
+		const TSharedPtr<PathDatabaseFlatFile> m_PendingAnchors; //Only read by the snapshot, so it may be written on any thread
+		SuggestionDatabasePath::ContributionMap m_Contributions;
+		const SuggestionDatabasePath::PendingContributionsPtr m_PendingContributions;
+		bool m_HasUnattributedUses;
+	};
+
+	NodeSignatureTable::SignatureId DeserializeLegacyNodeEntry(FArchive& a_Archive)
+	{
+		FString signature;
+		FGuid signatureGuid;
+		FText title;
+		a_Archive << signature << signatureGuid << title;
+		return NodeSignatureTable::Get().FindOrAdd(signatureGuid, FBlueprintNodeSignature(signature), title);
+	}
+
+	/** Reads a VERSION_0_1 database, which stored the full signature and title in every node entry */
+	void DeserializeLegacyDatabase(FArchive& a_Archive, SuggestionDatabasePath::PredictionDatabase& a_Database)
+	{
+		a_Database.Empty();
+
+		int32 numAnchors = 0;
+		a_Archive << numAnchors;
+		for (int32 anchorIndex = 0; anchorIndex < numAnchors; ++anchorIndex)
+		{
+			FString anchorSignature;
+			int32 numEntries = 0;
+			a_Archive << anchorSignature << numEntries;
+			for (int32 entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+			{
+				PathPredictionEntry entry;
+				int32 direction = 0;
+				a_Archive << direction;
+				entry.m_Direction = (EPathDirection)direction;
+				entry.m_PredictionVertex = PathNodeEntry(DeserializeLegacyNodeEntry(a_Archive));
+				entry.m_AnchorVertex = PathNodeEntry(DeserializeLegacyNodeEntry(a_Archive));
+
+				int32 contextLength = 0;
+				a_Archive << contextLength;
+				for (int32 i = 0; i < contextLength; ++i)
+				{
+					entry.m_ContextPath.PushNode(PathNodeEntry(DeserializeLegacyNodeEntry(a_Archive)));
+				}
+				a_Archive << entry.m_NumUses;
+
+				a_Database.FindOrAdd(entry.m_AnchorVertex.m_SignatureId).AddUses(entry);
+			}
 		}
 	}
 
@@ -239,51 +716,37 @@ namespace
 	}
 }
 
-SuggestionDatabasePath::NodeIndexType::NodeIndexType() :
-	m_NodeSignature("DEFAULT_INVALID_SIGNATURE")
-{
-}
-
-SuggestionDatabasePath::NodeIndexType::NodeIndexType(const UK2Node& a_Node) :
-	m_NodeSignature(a_Node.GetSignature().ToString())
-{
-}
-
-SuggestionDatabasePath::NodeIndexType::NodeIndexType(const PathNodeEntry& a_NodeEntry) :
-	m_NodeSignature(a_NodeEntry.m_NodeSignature.ToString())
-{
-}
-
-bool SuggestionDatabasePath::NodeIndexType::operator ==(const NodeIndexType& a_Other) const
-{
-	return m_NodeSignature == a_Other.m_NodeSignature;
-}
-
-uint32 GetTypeHash(const SuggestionDatabasePath::NodeIndexType& a_Instance)
-{
-	return FCrc::MemCrc32(*a_Instance.m_NodeSignature, a_Instance.m_NodeSignature.Len() * sizeof(TCHAR));
-}
-
-FArchive& operator << (FArchive& a_Archive, SuggestionDatabasePath::NodeIndexType& a_Value)
-{
-	return a_Archive << a_Value.m_NodeSignature;
-}
-
 SuggestionDatabasePath::SuggestionDatabasePath()
-	: m_SuggestionFlags(ESuggestionFlags::CalculateContext)
+	: m_HasUnattributedUses(false)
+	, m_IsRebuilding(false)
+	, m_IsParsingIntoRebuild(false)
+	, m_HasUnsavedChanges(false)
+	, m_LoadedJournalSequence(0)
+	, m_IsJournaling(false)
+	, m_UseSign(1)
+	, m_SuggestionFlags(ESuggestionFlags::CalculateContext)
 	, m_ToggleFlagCommand(TEXT("BIPlugin_ToggleSelectionFlag"), TEXT("Toggles selection state of certain flags. \
 		Available flags are: 'SortUsesOverContext' and 'CalculateContext'"),
 	FConsoleCommandWithArgsDelegate::CreateRaw(this, &SuggestionDatabasePath::ToggleSuggestionFlag))
+	, m_PathWalkStatsCommand(TEXT("BIPlugin_PathWalkStats"), TEXT("Logs how many paths were found when learning and querying, \
+		and how many links were not followed because a walk exceeded BIPlugin.PathBudget"),
+	FConsoleCommandDelegate::CreateRaw(this, &SuggestionDatabasePath::LogPathWalkStats))
 {
 }
 
 SuggestionDatabasePath::~SuggestionDatabasePath()
 {
+	CancelRebuild();
 	FlushDatabase();
 }
 
 void SuggestionDatabasePath::FlushDatabase()
 {
+	m_PendingFlatFile.Reset();
+	m_PendingContributions.Reset();
+	m_Contributions.Empty();
+	m_HasUnattributedUses = false;
+	m_HasUnsavedChanges = true;
 	m_ForwardPredictionDatabase.Empty();
 	m_BackwardPredictionDatabase.Empty();
 }
@@ -298,85 +761,407 @@ void SuggestionDatabasePath::FlushDatabase()
 #endif
 
 void SuggestionDatabasePath::ProvideSuggestions(const FBlueprintSuggestionContext& a_Context, int32 a_SuggestionCount, TArray<Suggestion>& a_Output)
+{
+	const uint32 startTime = FPlatformTime::Cycles();
+
+	SuggestionQueryRef query = CreateQuery(a_Context, a_SuggestionCount);
+	ExecuteQuery(*query);
+	a_Output.Append(query->m_Results);
+
+	UE_LOG(BILog, BI_VERBOSE, TEXT("Got %i suggestions (%.2f ms): "), a_Output.Num(), FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startTime));
+	for (const auto& suggestion : a_Output)
+	{
+		UE_LOG(BILog, BI_VERBOSE, TEXT("\t%s"), *suggestion.GetNodeSignature().ToString());
+	}
+}
+
+SuggestionDatabaseBase::SuggestionQueryRef SuggestionDatabasePath::CreateQuery(const FBlueprintSuggestionContext& a_Context, int32 a_SuggestionCount)
 {
 	verify(a_Context.Graphs.Num() == 1); //We assume that we are only dealing with a single graph.
 	verify(a_Context.Pins.Num() == 1); //We assume that we are only dealing with one connected pin now.
 
-	const uint32 startTime = FPlatformTime::Cycles();
-
 	UE_LOG(BILog, BI_VERBOSE, TEXT("Providing suggestions for context: (Node %s, PinType %s)"),
 		*a_Context.Pins[0].OwnerNode->GetNodeTitle(ENodeTitleType::MenuTitle).ToString(), 
 		*a_Context.Pins[0].Pin->PinType.PinCategory);
 
-	EPathDirection direction = (a_Context.Pins[0].Pin->Direction == EEdGraphPinDirection::EGPD_Input)? 
-		EPathDirection::Backward : EPathDirection::Forward;
+	//No query is running at this point, so the index can pick up signatures learned since the last query. Signatures without
+	//recorded information are resolved through template nodes, which can only be built on the game thread.
+	GetGraphNodeDatabase().UpdateCompatibilityIndex(a_Context.Graphs[0]);
+
+	const UEdGraphPin& connectingPin = *a_Context.Pins[0].Pin;
 	const UK2Node& ownerNode = *a_Context.Pins[0].OwnerNode;
-	NodeIndexType nodeIndex = NodeIndexType(ownerNode);
+
+	SuggestionQueryRef query = MakeShareable(new SuggestionQuery());
+	query->m_Direction = (connectingPin.Direction == EEdGraphPinDirection::EGPD_Input)? 
+		EPathDirection::Backward : EPathDirection::Forward;
+	query->m_AnchorId = NodeSignatureCache::Get().Find(ownerNode);
+	LoadPendingAnchor(query->m_Direction, query->m_AnchorId);
+	query->m_SuggestionCount = a_SuggestionCount;
+	query->m_HasConnectingPin = true;
+	query->m_ConnectingPinType = PinTypeTable::Get().FindOrAdd(connectingPin.PinType);
+	query->m_ConnectingPinDirection = connectingPin.Direction;
+	query->m_SourcePin = &connectingPin;
+	query->m_ContextGraph = a_Context.Graphs[0];
+	query->m_ContextGraphName = a_Context.Graphs[0]->GetName();
+
+	//Pins of context specific nodes depend on the blueprint they are placed in, which may need template nodes for the context graph.
+	const PathPredictionList* predictions = GetPredictionDatabase(query->m_Direction).Find(query->m_AnchorId);
+	if (predictions != nullptr)
+	{
+		GetGraphNodeDatabase().CheckContextSpecificSignatures(predictions->GetSignatureIds(), query->m_ConnectingPinType,
+			UEdGraphPin::GetComplementaryDirection(query->m_ConnectingPinDirection), query->m_ContextGraph, 
+			query->m_ContextSpecificSignatures, query->m_ContextCompatibleSignatures);
+	}
 
 	//TODO: BlueprintGraph.K2Node_VariableGet::GetSignature() Fix to differentiate between fields? 
-	TArray<PathContextPath> availableContextPaths = FindAllContextPaths(ownerNode, direction);
+	FindAllContextPaths(ownerNode, query->m_Direction, m_PathTrie, query->m_ContextPaths);
 
-	UE_LOG(BILog, BI_VERBOSE, TEXT("Found %i context paths: "), availableContextPaths.Num());
-	for (const PathContextPath& contextPath : availableContextPaths)
+	UE_LOG(BILog, BI_VERBOSE, TEXT("Found %i context paths: "), query->m_ContextPaths.Num());
+	for (const PathContextPath& contextPath : query->m_ContextPaths)
 	{
 		UE_LOG(BILog, BI_VERBOSE, TEXT("\t%s >> %s"), 
-			*a_Context.Pins[0].OwnerNode->GetNodeTitle(ENodeTitleType::MenuTitle).ToString(), *contextPath.GetPathString());
+			*ownerNode.GetNodeTitle(ENodeTitleType::MenuTitle).ToString(), *contextPath.GetPathString());
+	}
+
+	return query;
+}
+
+void SuggestionDatabasePath::SelectTopNSuggestions(TArray<Suggestion>& a_InOutSuggestions, int32 a_MaxSuggestionCount, int32 a_Flags)
+{
+	if ((a_Flags & ESuggestionFlags::SortUsesOverContext) != 0)
+	{
+		SelectTopNSuggestionsUsingPredicate(a_InOutSuggestions, a_MaxSuggestionCount, SuggestionNodeSortingUsesOverContext());
 	}
+	else
+	{
+		SelectTopNSuggestionsUsingPredicate(a_InOutSuggestions, a_MaxSuggestionCount, SuggestionNodeSortingContextOverUses());
+	}
+}
 
-	PredictionDatabase db = (direction == EPathDirection::Forward) ? m_ForwardPredictionDatabase : m_BackwardPredictionDatabase;
+void SuggestionDatabasePath::ExecuteQuery(SuggestionQuery& a_Query)
+{
+	const TArray<PathContextPath>& contextPaths = a_Query.m_ContextPaths;
+	TArray<Suggestion>& output = a_Query.m_Results;
+	output.Reset();
+
+	//Borrow the database for this direction, copying it would cost O(database size) per query.
+	const PredictionDatabase& db = GetPredictionDatabase(a_Query.m_Direction);
 
 	TIMING_START(suggestionTimer, "FindSuggestionPaths");
-	const TArray<PathPredictionEntry>* suggestionPaths = db.Find(nodeIndex);
+	const PathPredictionList* predictions = db.Find(a_Query.m_AnchorId);
 	TIMING_LOG(suggestionTimer);
 
-	if (suggestionPaths != nullptr)
+	if (predictions != nullptr)
 	{
-		TIMING_START(compatibilityTimer, "RemoveIncompatibleSuggestions");
-		TArray<PathPredictionEntry> compatibleEntries = RemoveIncompatibleSuggestionsBasedOnConnectablePinTypes(
-			*suggestionPaths, *a_Context.Pins[0].Pin, GetGraphNodeDatabase(), a_Context.Graphs[0]);
-		TIMING_LOG(compatibilityTimer);
+		TIMING_START(scoreTimer, "ScoreSuggestions");
+		const bool calculateContext = (m_SuggestionFlags & ESuggestionFlags::CalculateContext) != 0;
+
+		//Every (entry, context path) pair used to produce a suggestion before they were combined, so uses count once per context path.
+		const int32 usesMultiplier = contextPaths.Num();
+		if (usesMultiplier == 0)
+		{
+			return;
+		}
+
+		//Candidates are intersected with the signatures that fit the connecting pin before any entry is visited, so 
+		//scoring scales with the number of compatible signatures instead of the anchor's whole history.
+		const TArray<NodeSignatureTable::SignatureId>& anchorSignatures = predictions->GetSignatureIds();
+		TArray<NodeSignatureTable::SignatureId> candidateSignatures;
+		if (a_Query.m_HasConnectingPin)
+		{
+			const GraphNodeInformationDatabase& nodeInfoDatabase = GetGraphNodeDatabase();
+			const EEdGraphPinDirection otherPinDirection = UEdGraphPin::GetComplementaryDirection(a_Query.m_ConnectingPinDirection);
+			const TArray<NodeSignatureTable::SignatureId>* compatibleSignatures = 
+				nodeInfoDatabase.FindCompatibleSignatures(a_Query.m_ConnectingPinType, otherPinDirection);
+			if (compatibleSignatures != nullptr)
+			{
+				NodeSignatureTable::IntersectSorted(anchorSignatures, *compatibleSignatures, candidateSignatures);
+			}
 
-		TIMING_START(filterTimer, "FilterSuggestions");
-		FilterSuggestionsUsingContextPaths(compatibleEntries, availableContextPaths, a_Output, m_SuggestionFlags);
-		TIMING_LOG(filterTimer);
+			//Context specific signatures were checked against the context graph when the query was created.
+			const TArray<NodeSignatureTable::SignatureId>& contextSpecificSignatures = a_Query.m_ContextSpecificSignatures;
+			if (contextSpecificSignatures.Num() > 0)
+			{
+				candidateSignatures.RemoveAll([&contextSpecificSignatures](NodeSignatureTable::SignatureId a_Id)
+				{
+					const int32 index = NodeSignatureTable::LowerBound(contextSpecificSignatures, a_Id);
+					return index < contextSpecificSignatures.Num() && contextSpecificSignatures[index] == a_Id;
+				});
+				candidateSignatures.Append(a_Query.m_ContextCompatibleSignatures);
+				candidateSignatures.Sort();
+			}
+
+			//Signatures interned after the index was last updated are checked one by one.
+			const int32 firstUnindexed = NodeSignatureTable::LowerBound(anchorSignatures, nodeInfoDatabase.GetNumIndexedSignatures());
+			for (int32 i = firstUnindexed; i < anchorSignatures.Num(); ++i)
+			{
+				if (IsCompatibleWithConnectingPin(PathNodeEntry(anchorSignatures[i]), a_Query, nodeInfoDatabase))
+				{
+					candidateSignatures.Add(anchorSignatures[i]);
+				}
+			}
+		}
+		else
+		{
+			candidateSignatures = anchorSignatures;
+		}
 
-		TIMING_START(combineTimer, "CombineSuggestions");
-		CombineSuggestions(a_Output);
-		TIMING_LOG(combineTimer);
+		//Entries are grouped per signature, so each candidate produces exactly one suggestion. The most used are scored first,
+		//which lets scoring stop once the remaining candidates cannot make it into the selection.
+		TArray<SuggestionCandidate> candidates;
+		candidates.AddUninitialized(candidateSignatures.Num());
+		for (int32 i = 0; i < candidateSignatures.Num(); ++i)
+		{
+			candidates[i].m_SignatureId = candidateSignatures[i];
+			candidates[i].m_NumUses = predictions->GetSignatureUses(candidateSignatures[i]);
+		}
+		candidates.Sort(SuggestionCandidateSortingMostUsed());
 
-		TIMING_START(selectTopTimer, "SelectTopN");
-		SelectTopNSuggestions(a_Output, a_SuggestionCount, m_SuggestionFlags);
-		TIMING_LOG(selectTopTimer);
+		const bool completed = ((m_SuggestionFlags & ESuggestionFlags::SortUsesOverContext) != 0) ?
+			ScoreCandidates(candidates, *predictions, calculateContext, usesMultiplier, a_Query, SuggestionNodeSortingUsesOverContext()) :
+			ScoreCandidates(candidates, *predictions, calculateContext, usesMultiplier, a_Query, SuggestionNodeSortingContextOverUses());
+		if (!completed)
+		{
+			output.Reset();
+		}
+		TIMING_LOG(scoreTimer);
 	}
+}
 
-	UE_LOG(BILog, BI_VERBOSE, TEXT("Got %i suggestions (%.2f ms): "), a_Output.Num(), FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startTime));
-	for (const auto& suggestion : a_Output)
+const SuggestionDatabasePath::PredictionDatabase& SuggestionDatabasePath::GetPredictionDatabase(EPathDirection a_Direction) const
+{
+	return (a_Direction == EPathDirection::Forward) ? m_ForwardPredictionDatabase : m_BackwardPredictionDatabase;
+}
+
+SuggestionDatabasePath::PredictionDatabase& SuggestionDatabasePath::GetPredictionDatabase(EPathDirection a_Direction)
+{
+	return const_cast<PredictionDatabase&>((const_cast<const SuggestionDatabasePath*>(this))->GetPredictionDatabase(a_Direction));
+}
+
+bool SuggestionDatabasePath::HasSuggestions() const
+{
+	return m_BackwardPredictionDatabase.Num() > 0 || m_ForwardPredictionDatabase.Num() > 0 || m_PendingFlatFile.IsValid();
+}
+
+void SuggestionDatabasePath::BeginRebuild()
+{
+	CancelRebuild();
+	m_IsRebuilding = true;
+}
+
+void SuggestionDatabasePath::RebuildBlueprints(const TArray<const UBlueprint*>& a_Blueprints, const TArray<PathGraphSnapshot>& a_Snapshots)
+{
+	check(m_IsRebuilding);
+	//Shards attribute their paths to the blueprint of each snapshot when they are merged.
+	TGuardValue<bool> parseIntoRebuild(m_IsParsingIntoRebuild, true);
+	ParseGraphSnapshots(a_Snapshots, GetFillThreadCount());
+	for (const UBlueprint* blueprint : a_Blueprints)
 	{
-		UE_LOG(BILog, BI_VERBOSE, TEXT("\t%s"), *suggestion.GetNodeSignature().ToString());
+		m_RebuiltBlueprints.Add(blueprint);
 	}
 }
 
-bool SuggestionDatabasePath::HasSuggestions() const
+void SuggestionDatabasePath::FinishRebuild()
+{
+	check(m_IsRebuilding);
+	Exchange(m_ForwardPredictionDatabase, m_RebuildForwardPredictionDatabase);
+	Exchange(m_BackwardPredictionDatabase, m_RebuildBackwardPredictionDatabase);
+	Exchange(m_Contributions, m_RebuildContributions);
+	m_PendingFlatFile.Reset();
+	m_PendingContributions.Reset();
+	m_HasUnattributedUses = false;
+	m_HasUnsavedChanges = true;
+	CancelRebuild();
+}
+
+void SuggestionDatabasePath::CancelRebuild()
+{
+	m_RebuildForwardPredictionDatabase.Empty();
+	m_RebuildBackwardPredictionDatabase.Empty();
+	m_RebuildContributions.Empty();
+	m_RebuiltBlueprints.Empty();
+	m_IsRebuilding = false;
+}
+
+bool SuggestionDatabasePath::IsRebuilding() const
+{
+	return m_IsRebuilding;
+}
+
+void SuggestionDatabasePath::ReingestBlueprint(const UBlueprint& a_Blueprint)
 {
-	return m_BackwardPredictionDatabase.Num() > 0 || m_ForwardPredictionDatabase.Num() > 0;
+	//Decoding marks the database as unattributed if the stored contributions turn out to be malformed.
+	LoadPendingContributions();
+	//Which of the unattributed uses came from this blueprint is unknown, so parsing it again would count them twice.
+	//Once a rebuild has recorded every contribution this no longer applies, the rebuilt databases are still kept current.
+	if (m_HasUnattributedUses)
+	{
+		UE_LOG(BILog, Log, TEXT("Not re-ingesting blueprint '%s', the suggestion database was learned without per blueprint contributions. ")
+			TEXT("Run BIPlugin_RebuildSuggestionCache to enable re-ingesting"), *a_Blueprint.GetName());
+	}
+	else
+	{
+		TGuardValue<bool> journaling(m_IsJournaling, true);
+		ReparseBlueprint(a_Blueprint);
+		FlushJournal();
+	}
+
+	if (m_IsRebuilding && m_RebuiltBlueprints.Contains(&a_Blueprint))
+	{
+		TGuardValue<bool> parseIntoRebuild(m_IsParsingIntoRebuild, true);
+		ReparseBlueprint(a_Blueprint);
+	}
+}
+
+void SuggestionDatabasePath::ReparseBlueprint(const UBlueprint& a_Blueprint)
+{
+	const FName blueprintName = GetBlueprintName(&a_Blueprint);
+	TGuardValue<FName> contributingBlueprint(m_ContributingBlueprint, blueprintName);
+
+	if (!m_IsParsingIntoRebuild)
+	{
+		LoadPendingContributions();
+	}
+	const ContributionMap& contributions = m_IsParsingIntoRebuild ? m_RebuildContributions : m_Contributions;
+	const BlueprintContribution* previousContribution = contributions.Find(blueprintName);
+	if (previousContribution != nullptr)
+	{
+		//Copied as subtracting the entries removes them from the contribution as well.
+		const BlueprintContribution subtractedContribution = *previousContribution;
+		TGuardValue<int32> useSign(m_UseSign, -1);
+		subtractedContribution.ForEachEntry([this](const PathPredictionEntry& a_Entry)
+		{
+			AddToPredictionDatabase(a_Entry, a_Entry.m_Direction);
+		});
+	}
+
+	ParseBlueprint(a_Blueprint);
 }
 
 void SuggestionDatabasePath::GenerateSuggestionForCreatedLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB)
 {
-	ParseNode(a_NodeA, EPathDirection::Forward, a_NodeB);
-	ParseNode(a_NodeA, EPathDirection::Backward, a_NodeB);
-	ParseNode(a_NodeB, EPathDirection::Forward, a_NodeA);
-	ParseNode(a_NodeB, EPathDirection::Backward, a_NodeA);
+	ParseLinkChange(a_NodeA, a_NodeB, 1);
+}
+
+void SuggestionDatabasePath::RemoveSuggestionForBrokenLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB)
+{
+	//The paths through the link as the graph is now are forgotten. They only match what was learned when the link was created
+	//if the nodes around it did not change since, otherwise some uses stay behind until the blueprint is re-ingested.
+	ParseLinkChange(a_NodeA, a_NodeB, -1);
+}
+
+void SuggestionDatabasePath::ParseLinkChange(const UK2Node& a_NodeA, const UK2Node& a_NodeB, int32 a_UseSign)
+{
+	const UBlueprint* blueprint = FBlueprintEditorUtils::FindBlueprintForNode(&a_NodeA);
+	if (a_NodeA.GetGraph() != nullptr)
+	{
+		RecordNodeInformation(*a_NodeA.GetGraph());
+	}
+	TGuardValue<int32> useSign(m_UseSign, a_UseSign);
+	TGuardValue<FName> contributingBlueprint(m_ContributingBlueprint, GetBlueprintName(blueprint));
+	{
+		TGuardValue<bool> journaling(m_IsJournaling, true);
+		ParseCreatedLink(a_NodeA, a_NodeB);
+		FlushJournal();
+	}
+
+	//Blueprints that have not been visited by the rebuild yet will see the change when they are parsed.
+	if (m_IsRebuilding && m_RebuiltBlueprints.Contains(blueprint))
+	{
+		TGuardValue<bool> parseIntoRebuild(m_IsParsingIntoRebuild, true);
+		ParseCreatedLink(a_NodeA, a_NodeB);
+	}
 }
 
 void SuggestionDatabasePath::Serialize(FArchive& a_Archive)
 {
 	int32 fileVersion = (int32)EDatabasePathSerializeVersion::VERSION_LATEST;
+	if (!a_Archive.IsLoading())
+	{
+		//Anchors that were never used are copied from the loaded file as they are, instead of decoding them first.
+		bool hasUnattributedUses = m_HasUnattributedUses;
+		TArray<uint8> contributionData = EncodeContributions(m_Contributions, m_PendingContributions, hasUnattributedUses);
+		WriteDatabaseFile(a_Archive, m_ForwardPredictionDatabase, m_BackwardPredictionDatabase, m_PendingFlatFile.Get(), contributionData, 
+			hasUnattributedUses, GetJournalSequence());
+		m_HasUnsavedChanges = false;
+		return;
+	}
+
 	a_Archive << fileVersion;
-	if (fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_LATEST)
+	if (fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_LATEST || 
+		fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_0_6 ||
+		fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_0_5 ||
+		fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_0_4 ||
+		fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_0_3)
+	{
+		FlushDatabase();
+		m_LoadedJournalSequence = 0;
+		if (fileVersion >= (int32)EDatabasePathSerializeVersion::VERSION_0_4)
+		{
+			a_Archive << m_LoadedJournalSequence;
+		}
+		if (fileVersion >= (int32)EDatabasePathSerializeVersion::VERSION_0_6)
+		{
+			a_Archive << m_HasUnattributedUses;
+		}
+		TSharedPtr<PendingContributions, ESPMode::ThreadSafe> pendingContributions;
+		if (fileVersion >= (int32)EDatabasePathSerializeVersion::VERSION_0_7)
+		{
+			//Contributions are only needed once a blueprint is re-ingested, so they stay encoded until then.
+			pendingContributions = MakeShareable(new PendingContributions());
+			a_Archive << pendingContributions->m_Data;
+		}
+		else if (fileVersion >= (int32)EDatabasePathSerializeVersion::VERSION_0_5)
+		{
+			TArray<uint8> legacyContributionData;
+			a_Archive << legacyContributionData;
+			FMemoryReader contributionReader(legacyContributionData);
+			DeserializeLegacyContributions(contributionReader, m_Contributions);
+		}
+
+		//Read the remainder with one bulk read; entries are only decoded once their anchor is used.
+		TArray<uint8> fileData;
+		fileData.AddUninitialized(static_cast<int32>(a_Archive.TotalSize() - a_Archive.Tell()));
+		a_Archive.Serialize(fileData.GetData(), fileData.Num());
+		m_PendingFlatFile = PathDatabaseFlatFile::Load(fileData);
+		if (!m_PendingFlatFile.IsValid())
+		{
+			UE_LOG(BILog, Warning, TEXT("Could not deserialize suggestion database information. File is malformed"));
+			m_Contributions.Empty();
+		}
+		else if (fileVersion < (int32)EDatabasePathSerializeVersion::VERSION_0_5)
+		{
+			//Blueprints were learned before their contributions were recorded, so none of these uses can be subtracted.
+			m_HasUnattributedUses = m_PendingFlatFile->NumPendingAnchors() > 0;
+		}
+		else if (pendingContributions.IsValid())
+		{
+			pendingContributions->m_FileToTableIds = m_PendingFlatFile->GetFileToTableIds();
+			m_PendingContributions = pendingContributions;
+		}
+		m_HasUnsavedChanges = false;
+	}
+	else if (fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_0_2)
 	{
+		UE_LOG(BILog, Log, TEXT("Migrating suggestion database from version %i to %i"), fileVersion, 
+			static_cast<int32>(EDatabasePathSerializeVersion::VERSION_LATEST));
+		FlushDatabase();
+		TArray<NodeSignatureTable::SignatureId> fileToTableIds;
+		NodeSignatureTable::Get().Serialize(a_Archive, fileToTableIds);
 		a_Archive << m_ForwardPredictionDatabase;
 		a_Archive << m_BackwardPredictionDatabase;
+		RemapSignatureIds(m_ForwardPredictionDatabase, fileToTableIds);
+		RemapSignatureIds(m_BackwardPredictionDatabase, fileToTableIds);
+		m_HasUnattributedUses = m_ForwardPredictionDatabase.Num() > 0 || m_BackwardPredictionDatabase.Num() > 0;
+	}
+	else if (fileVersion == (int32)EDatabasePathSerializeVersion::VERSION_0_1)
+	{
+		UE_LOG(BILog, Log, TEXT("Migrating suggestion database from version %i to %i"), fileVersion, 
+			static_cast<int32>(EDatabasePathSerializeVersion::VERSION_LATEST));
+		FlushDatabase();
+		DeserializeLegacyDatabase(a_Archive, m_ForwardPredictionDatabase);
+		DeserializeLegacyDatabase(a_Archive, m_BackwardPredictionDatabase);
+		m_HasUnattributedUses = m_ForwardPredictionDatabase.Num() > 0 || m_BackwardPredictionDatabase.Num() > 0;
 	}
 	else
 	{
@@ -385,6 +1170,68 @@ void SuggestionDatabasePath::Serialize(FArchive& a_Archive)
 	}
 }
 
+SuggestionDatabaseBase::SuggestionDatabaseSnapshotRef SuggestionDatabasePath::CreateSnapshot()
+{
+	//Anchors that were never used stay encoded, the snapshot writes them from its own copy of the pending set.
+	m_HasUnsavedChanges = false;
+	TSharedPtr<PathDatabaseFlatFile> pendingAnchors;
+	if (m_PendingFlatFile.IsValid())
+	{
+		pendingAnchors = m_PendingFlatFile->CopyPendingAnchors();
+	}
+	return MakeShareable(new PathDatabaseSnapshot(m_ForwardPredictionDatabase, m_BackwardPredictionDatabase, pendingAnchors, m_Contributions, 
+		m_PendingContributions, m_HasUnattributedUses, GetJournalSequence()));
+}
+
+void SuggestionDatabasePath::MarkUnsaved()
+{
+	m_HasUnsavedChanges = true;
+}
+
+bool SuggestionDatabasePath::HasUnsavedChanges() const
+{
+	return m_HasUnsavedChanges;
+}
+
+void SuggestionDatabasePath::OpenJournal(const FString& a_JournalFilePath)
+{
+	m_Journal = MakeShareable(new PathDatabaseJournal(a_JournalFilePath));
+
+	TArray<PathDatabaseJournal::JournalDelta> deltas;
+	m_Journal->Open(m_LoadedJournalSequence, deltas);
+	for (const PathDatabaseJournal::JournalDelta& delta : deltas)
+	{
+		TGuardValue<FName> contributingBlueprint(m_ContributingBlueprint, delta.m_Blueprint);
+		AddToPredictionDatabase(delta.m_Entry, delta.m_Entry.m_Direction);
+	}
+}
+
+void SuggestionDatabasePath::CompactJournal(uint64 a_SavedSequence)
+{
+	if (m_Journal.IsValid())
+	{
+		m_Journal->Compact(a_SavedSequence);
+	}
+}
+
+bool SuggestionDatabasePath::NeedsJournalCompaction() const
+{
+	return m_Journal.IsValid() && m_Journal->GetFileSize() > CVarJournalCompactionSizeKB.GetValueOnGameThread() * 1024;
+}
+
+void SuggestionDatabasePath::FlushJournal()
+{
+	if (m_Journal.IsValid())
+	{
+		m_Journal->Flush();
+	}
+}
+
+uint64 SuggestionDatabasePath::GetJournalSequence() const
+{
+	return m_Journal.IsValid() ? m_Journal->GetLastSequence() : m_LoadedJournalSequence;
+}
+
 SuggestionDatabaseBase::CrossValidateResult SuggestionDatabasePath::CrossValidateTest(UEdGraph& a_Graph, const UK2Node& a_Node, int32 a_NumSuggestionsToUse)
 {
 	CrossValidateResult result;
@@ -404,6 +1251,7 @@ SuggestionDatabaseBase::CrossValidateResult SuggestionDatabasePath::CrossValidat
 			context.Graphs.Push(&a_Graph);
 			context.Pins.Push(pinInfo);
 
+			suggestResult.Reset();
 			const uint32 startCycles = FPlatformTime::Cycles();
 			ProvideSuggestions(context, a_NumSuggestionsToUse, suggestResult);
 			uint32 cyclesTaken = FPlatformTime::Cycles() - startCycles;
@@ -414,8 +1262,7 @@ SuggestionDatabaseBase::CrossValidateResult SuggestionDatabasePath::CrossValidat
 			for (UEdGraphPin* otherPin : pin->LinkedTo)
 			{
 				UK2Node* otherNode = GetNodeFromPin(otherPin);
-				FBlueprintNodeSignature otherSignature = otherNode->GetSignature();
-				FGuid otherSignatureGuid = otherSignature.AsGuid();
+				FGuid otherSignatureGuid = NodeSignatureCache::Get().GetSignatureGuid(*otherNode);
 				
 				int32 index = 0;
 				for (const Suggestion& suggest : suggestResult)
@@ -437,49 +1284,158 @@ SuggestionDatabaseBase::CrossValidateResult SuggestionDatabasePath::CrossValidat
 
 void SuggestionDatabasePath::ParseNode(const UK2Node& a_Node, EPathDirection a_Direction)
 {
-	TArray<PathPredictionEntry> preditionPaths = CreatePredictionPathsForNode(a_Node, a_Direction);
-	for (PathPredictionEntry entry : preditionPaths)
+	FindPredictionPaths(LiveGraphPathSource(a_Direction), &a_Node, PathWalkLimits(), m_PathTrie);
+	ForEachPredictionEntry(m_PathTrie, NodeSignatureCache::Get().FindOrAdd(a_Node), a_Direction, 
+		[this, a_Direction](const PathPredictionEntry& a_Entry)
+		{
+			AddToPredictionDatabase(a_Entry, a_Direction);
+		});
+}
+
+void SuggestionDatabasePath::ParseNode(const UK2Node& a_Node, EPathDirection a_Direction, const UK2Node& a_AnchorNodeConstraint)
+{
+	const PathNodeEntry anchorConstraint(a_AnchorNodeConstraint);
+	FindPredictionPaths(LiveGraphPathSource(a_Direction), &a_Node, PathWalkLimits(), m_PathTrie);
+	ForEachPredictionEntry(m_PathTrie, NodeSignatureCache::Get().FindOrAdd(a_Node), a_Direction, 
+		[this, a_Direction, &anchorConstraint](const PathPredictionEntry& a_Entry)
+		{
+			if (a_Entry.m_AnchorVertex == anchorConstraint)
+			{
+				AddToPredictionDatabase(a_Entry, a_Direction);
+			}
+		});
+}
+
+void SuggestionDatabasePath::ParseGraphSnapshot(const PathGraphSnapshot& a_Snapshot)
+{
+	const EPathDirection directions[] = { EPathDirection::Forward, EPathDirection::Backward };
+	const PathWalkLimits limits;
+	for (int32 node = 0; node < a_Snapshot.Num(); ++node)
 	{
-		AddToPredictionDatabase(entry, a_Direction);
+		for (EPathDirection direction : directions)
+		{
+			FindPredictionPaths(SnapshotPathSource(a_Snapshot, direction), node, limits, m_PathTrie);
+			ForEachPredictionEntry(m_PathTrie, a_Snapshot.GetSignatureId(node), direction, 
+				[this, direction](const PathPredictionEntry& a_Entry)
+				{
+					AddToPredictionDatabase(a_Entry, direction);
+				});
+		}
 	}
 }
 
-void SuggestionDatabasePath::ParseNode(const UK2Node& a_Node, EPathDirection a_Direction, const UK2Node& a_AnchorNodeConstraint)
+void SuggestionDatabasePath::ParseGraphSnapshots(const TArray<PathGraphSnapshot>& a_Snapshots, int32 a_NumThreads)
 {
-	TArray<PathPredictionEntry> preditionPaths = CreatePredictionPathsForNode(a_Node, a_Direction);
-	for (PathPredictionEntry entry : preditionPaths)
+	TArray<PredictionDatabaseShard> shards;
+	shards.AddDefaulted(FMath::Max(a_NumThreads, 1));
+	FThreadSafeCounter nextSnapshot;
+
+	if (shards.Num() == 1)
+	{
+		ParseSnapshotsIntoShard(a_Snapshots, nextSnapshot, shards[0]);
+	}
+	else
+	{
+		FGraphEventArray shardTasks;
+		for (PredictionDatabaseShard& shard : shards)
+		{
+			shardTasks.Add(TGraphTask<ParseSnapshotsShardTask>::CreateTask().ConstructAndDispatchWhenReady(a_Snapshots, nextSnapshot, shard));
+		}
+		FTaskGraphInterface::Get().WaitUntilTasksComplete(shardTasks, ENamedThreads::GameThread);
+	}
+
+	//Summing the uses of each shard gives the same database as parsing serially, only the entry order differs.
+	for (const PredictionDatabaseShard& shard : shards)
 	{
-		if (entry.m_AnchorVertex.m_NodeSignatureGuid == a_AnchorNodeConstraint.GetSignature().AsGuid())
+		m_ShardWalkStats.Add(shard.m_WalkStats);
+		for (const auto& contribution : shard.m_Contributions)
 		{
-			AddToPredictionDatabase(entry, a_Direction);
+			TGuardValue<FName> contributingBlueprint(m_ContributingBlueprint, contribution.Key);
+			contribution.Value.ForEachEntry([this](const PathPredictionEntry& a_Entry)
+			{
+				AddToPredictionDatabase(a_Entry, a_Entry.m_Direction);
+			});
 		}
 	}
 }
 
+void SuggestionDatabasePath::ParseCreatedLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB)
+{
+	ParseNode(a_NodeA, EPathDirection::Forward, a_NodeB);
+	ParseNode(a_NodeA, EPathDirection::Backward, a_NodeB);
+	ParseNode(a_NodeB, EPathDirection::Forward, a_NodeA);
+	ParseNode(a_NodeB, EPathDirection::Backward, a_NodeA);
+}
+
 void SuggestionDatabasePath::AddToPredictionDatabase(const PathPredictionEntry& a_Entry, EPathDirection a_Direction)
 {
-	PredictionDatabase& outputDatabase = (a_Direction == EPathDirection::Forward)? m_ForwardPredictionDatabase : 
-		m_BackwardPredictionDatabase;
+	PathPredictionEntry delta = a_Entry;
+	delta.m_NumUses *= m_UseSign;
 
-	NodeIndexType nodeIndex = NodeIndexType(a_Entry.m_AnchorVertex);
-	TArray<PathPredictionEntry>* predictions = outputDatabase.Find(nodeIndex);
-	if (predictions == nullptr)
+	if (!m_IsParsingIntoRebuild)
 	{
-		predictions = &(outputDatabase.Add(nodeIndex));
+		LoadPendingAnchor(a_Direction, delta.m_AnchorVertex.m_SignatureId);
+		m_HasUnsavedChanges = true;
+		if (m_IsJournaling && m_Journal.IsValid())
+		{
+			PathDatabaseJournal::JournalDelta journalDelta;
+			journalDelta.m_Entry = delta;
+			journalDelta.m_Blueprint = m_ContributingBlueprint;
+			m_Journal->Append(journalDelta);
+		}
 	}
 
-	PathPredictionEntry* match = predictions->FindByPredicate([&](const PathPredictionEntry& obj) -> bool
+	PredictionDatabase& outputDatabase = !m_IsParsingIntoRebuild ? GetPredictionDatabase(a_Direction) :
+		((a_Direction == EPathDirection::Forward) ? m_RebuildForwardPredictionDatabase : m_RebuildBackwardPredictionDatabase);
+	AddUsesToDatabase(outputDatabase, delta);
+
+	if (m_ContributingBlueprint != NAME_None)
 	{
-		return obj.CompareExcludingUses(a_Entry);
-	});
+		if (!m_IsParsingIntoRebuild)
+		{
+			LoadPendingContributions();
+		}
+		ContributionMap& contributions = m_IsParsingIntoRebuild ? m_RebuildContributions : m_Contributions;
+		BlueprintContribution& contribution = contributions.FindOrAdd(m_ContributingBlueprint);
+		contribution.AddUses(delta);
+		if (contribution.Num() == 0)
+		{
+			contributions.Remove(m_ContributingBlueprint);
+		}
+	}
+}
 
-	if (match != nullptr)
+void SuggestionDatabasePath::LoadPendingAnchor(EPathDirection a_Direction, NodeIndexType a_AnchorId)
+{
+	if (m_PendingFlatFile.IsValid())
 	{
-		match->m_NumUses++;
+		m_PendingFlatFile->LoadAnchor(a_Direction, a_AnchorId, GetPredictionDatabase(a_Direction));
+		if (m_PendingFlatFile->NumPendingAnchors() == 0)
+		{
+			m_PendingFlatFile.Reset();
+		}
 	}
-	else
+}
+
+void SuggestionDatabasePath::LoadPendingContributions()
+{
+	if (m_PendingContributions.IsValid())
 	{
-		predictions->Push(a_Entry);
+		if (!DecodeContributions(*m_PendingContributions, m_Contributions))
+		{
+			UE_LOG(BILog, Warning, TEXT("Could not decode the blueprint contributions of the suggestion database. File is malformed"));
+			m_HasUnattributedUses = true;
+		}
+		m_PendingContributions.Reset();
+	}
+}
+
+void SuggestionDatabasePath::LoadAllPendingAnchors()
+{
+	if (m_PendingFlatFile.IsValid())
+	{
+		m_PendingFlatFile->LoadAllAnchors(m_ForwardPredictionDatabase, m_BackwardPredictionDatabase);
+		m_PendingFlatFile.Reset();
 	}
 }
 
@@ -504,3 +1460,13 @@ void SuggestionDatabasePath::ToggleSuggestionFlag(const TArray<FString>& a_Args)
 		}
 	}
 }
+
+void SuggestionDatabasePath::LogPathWalkStats() const
+{
+	PathContextTrie::WalkStats stats = m_ShardWalkStats;
+	stats.Add(m_PathTrie.GetStats());
+	const uint64 numLinks = stats.m_NumPaths + stats.m_NumPrunedPaths;
+	UE_LOG(BILog, Display, TEXT("Path walks: %llu walks found %llu paths, %llu links pruned (%.1f%%). Context length %i, budget %i paths per walk"),
+		stats.m_NumWalks, stats.m_NumPaths, stats.m_NumPrunedPaths, (numLinks > 0) ? 100.0 * stats.m_NumPrunedPaths / numLinks : 0.0,
+		PathContextTrie::GetConfiguredContextLength(), PathContextTrie::GetConfiguredPathBudget());
+}
@@ -3,11 +3,23 @@
 #include "SuggestionDatabaseBase.h"
 #include "PathNodeEntry.h"
 #include "PathPredictionEntry.h"
+#include "PathPredictionList.h"
+#include "BlueprintContribution.h"
+#include "PathContextTrie.h"
+
+class PathDatabaseFlatFile;
+class PathDatabaseJournal;
 
 enum class EDatabasePathSerializeVersion
 {
 	VERSION_0_1,
-	VERSION_LATEST = VERSION_0_1
+	VERSION_0_2, //Node signatures interned in a table, entries store signature ids
+	VERSION_0_3, //Flat layout decoded in place, see PathDatabaseFlatFile
+	VERSION_0_4, //Journal sequence number of the last change contained in the file, followed by the 0_3 layout
+	VERSION_0_5, //Per blueprint contributions between the journal sequence number and the 0_3 layout
+	VERSION_0_6, //Whether the database has uses that are not attributed to a contribution, in front of the 0_5 contributions
+	VERSION_0_7, //Contributions as compact use counts sharing the signature table of the 0_3 layout instead of storing their own
+	VERSION_LATEST = VERSION_0_7
 };
 
 namespace ESuggestionFlags
@@ -22,44 +34,100 @@ namespace ESuggestionFlags
 class SuggestionDatabasePath: public SuggestionDatabaseBase
 {
 public:
-	class NodeIndexType
+	typedef NodeSignatureTable::SignatureId NodeIndexType;
+	typedef TMap<NodeIndexType, PathPredictionList> PredictionDatabase;
+	typedef TMap<FName, BlueprintContribution> ContributionMap;
+
+	/** Contributions as stored in a loaded database file. Never changed once loaded, so snapshots can share them */
+	struct PendingContributions
 	{
-	public:
-		NodeIndexType();
-		NodeIndexType(const UK2Node& a_Node);
-		NodeIndexType(const PathNodeEntry& a_NodeEntry);
-		bool operator ==(const NodeIndexType& a_Other) const;
-		friend uint32 GetTypeHash(const NodeIndexType& a_Instance);
-		friend FArchive& operator << (FArchive& a_Archive, NodeIndexType& a_Value);
-
-		FString m_NodeSignature;
+		TArray<uint8> m_Data;
+		TArray<NodeSignatureTable::SignatureId> m_FileToTableIds; //Of the flat file, whose signature table the contributions use
 	};
-
-	typedef TMap<NodeIndexType, TArray<PathPredictionEntry>> PredictionDatabase;
+	typedef TSharedPtr<const PendingContributions, ESPMode::ThreadSafe> PendingContributionsPtr;
 
 	SuggestionDatabasePath();
 	~SuggestionDatabasePath();
 
 	virtual void FlushDatabase() override;
 	virtual void ProvideSuggestions(const FBlueprintSuggestionContext& a_Context, int32 a_SuggestionCount, TArray<Suggestion>& a_Output) override;
+	virtual SuggestionQueryRef CreateQuery(const FBlueprintSuggestionContext& a_Context, int32 a_SuggestionCount) override;
+	virtual void ExecuteQuery(SuggestionQuery& a_Query) override;
 	virtual bool HasSuggestions() const override;
+	virtual void BeginRebuild() override;
+	virtual void RebuildBlueprints(const TArray<const UBlueprint*>& a_Blueprints, const TArray<PathGraphSnapshot>& a_Snapshots) override;
+	virtual void FinishRebuild() override;
+	virtual void CancelRebuild() override;
+	virtual bool IsRebuilding() const override;
+	virtual void ReingestBlueprint(const UBlueprint& a_Blueprint) override;
 	virtual void GenerateSuggestionForCreatedLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB) override;
+	virtual void RemoveSuggestionForBrokenLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB) override;
 	virtual void Serialize(FArchive& a_Archive) override;
+	virtual SuggestionDatabaseSnapshotRef CreateSnapshot() override;
+	virtual bool HasUnsavedChanges() const override;
+	virtual void MarkUnsaved() override;
+	virtual void OpenJournal(const FString& a_JournalFilePath) override;
+	virtual void CompactJournal(uint64 a_SavedSequence) override;
+	virtual bool NeedsJournalCompaction() const override;
 
 	virtual CrossValidateResult CrossValidateTest(UEdGraph& a_Graph, const UK2Node& a_Node, int32 a_NumSuggestionsToUse) override;
 
 protected:
 	virtual void ParseNode(const UK2Node& a_Node, EPathDirection a_Direction) override;
+	virtual void ParseGraphSnapshot(const PathGraphSnapshot& a_Snapshot) override;
+	virtual void ParseGraphSnapshots(const TArray<PathGraphSnapshot>& a_Snapshots, int32 a_NumThreads) override;
 
 private:
+	friend class SuggestionDatabaseBenchmark;
+
+	/** Keeps the best a_MaxSuggestionCount suggestions according to a_Flags (ESuggestionFlags), sorted best first */
+	static void SelectTopNSuggestions(TArray<Suggestion>& a_InOutSuggestions, int32 a_MaxSuggestionCount, int32 a_Flags);
+	const PredictionDatabase& GetPredictionDatabase(EPathDirection a_Direction) const;
+	PredictionDatabase& GetPredictionDatabase(EPathDirection a_Direction);
+
 	/** Creates suggestions for a node, but has the additional constraint of requiring the first node (Anchor) to match */
 	void ParseNode(const UK2Node& a_node, EPathDirection a_Direction, const UK2Node& a_AnchorNodeConstraint);
+	void ParseCreatedLink(const UK2Node& a_NodeA, const UK2Node& a_NodeB);
+	/** Learns (a_UseSign 1) or forgets (a_UseSign -1) a link in the current database, and in the rebuilt one if its blueprint was visited already */
+	void ParseLinkChange(const UK2Node& a_NodeA, const UK2Node& a_NodeB, int32 a_UseSign);
+	/** Subtracts the recorded contribution of a_Blueprint and parses it again, into the rebuilt database if m_IsParsingIntoRebuild is set */
+	void ReparseBlueprint(const UBlueprint& a_Blueprint);
 	void AddToPredictionDatabase(const PathPredictionEntry& a_Entry, EPathDirection a_PathDirection);
+	/** Decodes the blueprint contributions that are still in the loaded database file. Game thread only */
+	void LoadPendingContributions();
+	/** Decodes the entries of an anchor that are still in the loaded database file. Game thread only */
+	void LoadPendingAnchor(EPathDirection a_Direction, NodeIndexType a_AnchorId);
+	void LoadAllPendingAnchors();
+	/** Writes the deltas journaled since the last flush to disk, once per learned change */
+	void FlushJournal();
+	uint64 GetJournalSequence() const;
 
 	void ToggleSuggestionFlag(const TArray<FString>& a_Args);
+	void LogPathWalkStats() const;
 
 	PredictionDatabase m_ForwardPredictionDatabase;
 	PredictionDatabase m_BackwardPredictionDatabase;
+	TSharedPtr<PathDatabaseFlatFile> m_PendingFlatFile; //Anchors that have not been decoded from the database file yet
+	ContributionMap m_Contributions;
+	PendingContributionsPtr m_PendingContributions; //Decoded on first use
+	FName m_ContributingBlueprint; //Entries added while set are attributed to this blueprint
+	bool m_HasUnattributedUses; //Uses learned before contributions were recorded, re-ingesting would count them twice until a rebuild
+
+	PredictionDatabase m_RebuildForwardPredictionDatabase;
+	PredictionDatabase m_RebuildBackwardPredictionDatabase;
+	ContributionMap m_RebuildContributions;
+	TSet<const UBlueprint*> m_RebuiltBlueprints;
+	bool m_IsRebuilding;
+	bool m_IsParsingIntoRebuild; //Redirects AddToPredictionDatabase to the databases being rebuilt
+	bool m_HasUnsavedChanges;
+
+	TSharedPtr<PathDatabaseJournal> m_Journal;
+	uint64 m_LoadedJournalSequence;
+	bool m_IsJournaling; //Entries added while set are written to the journal
+	int32 m_UseSign; //AddToPredictionDatabase multiplies the uses of added entries with this, -1 forgets them
 	int32 m_SuggestionFlags; //ESuggestionFlags
+	PathContextTrie m_PathTrie; //Reused by training and queries on the game thread, so finding paths does not allocate
 	FAutoConsoleCommand m_ToggleFlagCommand;
+	PathContextTrie::WalkStats m_ShardWalkStats; //Walks of the parallel fill, which use a trie per shard
+	FAutoConsoleCommand m_PathWalkStatsCommand;
 };
@@ -0,0 +1,134 @@
+#include "BIPluginPrivatePCH.h"
+#include "SuggestionDatabaseRebuilder.h"
+
+#include "SuggestionDatabaseBase.h"
+#include "PathGraphSnapshot.h"
+
+namespace
+{
+	const int32 REBUILD_PROGRESS_REPORT_PERCENTAGE = 10;
+
+	TAutoConsoleVariable<float> CVarRebuildTimeBudgetMs(
+		TEXT("BIPlugin.RebuildTimeBudgetMs"),
+		5.0f,
+		TEXT("Time in milliseconds the suggestion database rebuild may spend per editor tick"),
+		ECVF_Default);
+}
+
+SuggestionDatabaseRebuilder::SuggestionDatabaseRebuilder(SuggestionDatabaseBase& a_Database, const FSimpleDelegate& a_CancelQueriesDelegate)
+	: m_Database(a_Database)
+	, m_CancelQueriesDelegate(a_CancelQueriesDelegate)
+	, m_NumParsedBlueprints(0)
+	, m_LastReportedPercentage(0)
+	, m_StartTime(0.0)
+{
+}
+
+SuggestionDatabaseRebuilder::~SuggestionDatabaseRebuilder()
+{
+	CancelRebuild();
+}
+
+void SuggestionDatabaseRebuilder::StartRebuild()
+{
+	if (IsRebuilding())
+	{
+		LogProgress();
+		return;
+	}
+
+	UE_LOG(BILog, Warning, TEXT("Rebuilding suggestion database using available blueprints in the background."));
+
+	m_BlueprintsToParse.Reset();
+	for (TObjectIterator<UBlueprint> blueprintIt; blueprintIt; ++blueprintIt)
+	{
+		m_BlueprintsToParse.Add(*blueprintIt);
+	}
+	m_NumParsedBlueprints = 0;
+	m_LastReportedPercentage = 0;
+	m_StartTime = FPlatformTime::Seconds();
+
+	m_Database.BeginRebuild();
+	m_TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &SuggestionDatabaseRebuilder::OnTick));
+}
+
+void SuggestionDatabaseRebuilder::CancelRebuild()
+{
+	if (IsRebuilding())
+	{
+		UE_LOG(BILog, Log, TEXT("Cancelled suggestion database rebuild after %i of %i blueprints"), 
+			m_NumParsedBlueprints, m_BlueprintsToParse.Num());
+		FTicker::GetCoreTicker().RemoveTicker(m_TickerHandle);
+		m_TickerHandle = FDelegateHandle();
+		m_BlueprintsToParse.Empty();
+		m_Database.CancelRebuild();
+	}
+}
+
+bool SuggestionDatabaseRebuilder::IsRebuilding() const
+{
+	return m_TickerHandle.IsValid();
+}
+
+void SuggestionDatabaseRebuilder::LogProgress() const
+{
+	if (IsRebuilding())
+	{
+		UE_LOG(BILog, Log, TEXT("Suggestion database rebuild in progress: %i of %i blueprints parsed (%.1f s)"),
+			m_NumParsedBlueprints, m_BlueprintsToParse.Num(), FPlatformTime::Seconds() - m_StartTime);
+	}
+	else
+	{
+		UE_LOG(BILog, Log, TEXT("No suggestion database rebuild in progress"));
+	}
+}
+
+bool SuggestionDatabaseRebuilder::OnTick(float a_DeltaTime)
+{
+	const double sliceEnd = FPlatformTime::Seconds() + CVarRebuildTimeBudgetMs.GetValueOnGameThread() / 1000.0;
+	TArray<const UBlueprint*> batch;
+	TArray<PathGraphSnapshot> snapshots;
+	while (m_NumParsedBlueprints < m_BlueprintsToParse.Num() && FPlatformTime::Seconds() < sliceEnd)
+	{
+		//Blueprints that were garbage collected since the rebuild started are skipped.
+		const UBlueprint* blueprint = m_BlueprintsToParse[m_NumParsedBlueprints].Get();
+		if (blueprint != nullptr)
+		{
+			m_Database.SnapshotBlueprint(*blueprint, snapshots);
+			batch.Add(blueprint);
+		}
+		++m_NumParsedBlueprints;
+	}
+	if (batch.Num() > 0)
+	{
+		m_Database.RebuildBlueprints(batch, snapshots);
+	}
+
+	const int32 percentage = (m_NumParsedBlueprints * 100) / FMath::Max(m_BlueprintsToParse.Num(), 1);
+	if (percentage >= m_LastReportedPercentage + REBUILD_PROGRESS_REPORT_PERCENTAGE)
+	{
+		m_LastReportedPercentage = percentage - (percentage % REBUILD_PROGRESS_REPORT_PERCENTAGE);
+		LogProgress();
+	}
+
+	if (m_NumParsedBlueprints < m_BlueprintsToParse.Num())
+	{
+		return true;
+	}
+
+	FinishRebuild();
+	return false;
+}
+
+void SuggestionDatabaseRebuilder::FinishRebuild()
+{
+	m_CancelQueriesDelegate.ExecuteIfBound();
+	m_Database.FinishRebuild();
+
+	UE_LOG(BILog, Warning, TEXT("Suggestion database rebuild finished: %i blueprints in %.1f s"),
+		m_BlueprintsToParse.Num(), FPlatformTime::Seconds() - m_StartTime);
+
+	//Returning false from the tick removes the ticker.
+	m_TickerHandle = FDelegateHandle();
+	m_BlueprintsToParse.Empty();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+class SuggestionDatabaseBase;
+/** Rebuilds the suggestion database from all loaded blueprints, a batch of blueprints per tick.
+ * Blueprints may only be read on the game thread, so each tick snapshots as many as fit in BIPlugin.RebuildTimeBudgetMs.
+ * The snapshots are then parsed on BIPlugin.FillThreadCount task graph workers while the game thread waits for them. */
+class SuggestionDatabaseRebuilder
+{
+public:
+	/** a_CancelQueriesDelegate is executed before the suggestion databases are modified in ways running queries could observe */
+	SuggestionDatabaseRebuilder(SuggestionDatabaseBase& a_Database, const FSimpleDelegate& a_CancelQueriesDelegate);
+	~SuggestionDatabaseRebuilder();
+
+	void StartRebuild();
+	void CancelRebuild();
+	bool IsRebuilding() const;
+	void LogProgress() const;
+
+private:
+	bool OnTick(float a_DeltaTime);
+	void FinishRebuild();
+
+	SuggestionDatabaseBase& m_Database;
+	FSimpleDelegate m_CancelQueriesDelegate;
+
+	TArray<TWeakObjectPtr<UBlueprint>> m_BlueprintsToParse;
+	int32 m_NumParsedBlueprints;
+	int32 m_LastReportedPercentage;
+	double m_StartTime;
+	FDelegateHandle m_TickerHandle;
+};
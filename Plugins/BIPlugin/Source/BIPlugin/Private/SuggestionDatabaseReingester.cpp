@@ -0,0 +1,100 @@
+#include "BIPluginPrivatePCH.h"
+#include "SuggestionDatabaseReingester.h"
+
+#include "SuggestionDatabaseBase.h"
+#include "NodeSignatureCache.h"
+
+SuggestionDatabaseReingester::SuggestionDatabaseReingester(SuggestionDatabaseBase& a_Database, const FSimpleDelegate& a_CancelQueriesDelegate)
+	: m_Database(a_Database)
+	, m_CancelQueriesDelegate(a_CancelQueriesDelegate)
+{
+	m_ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &SuggestionDatabaseReingester::OnObjectModified);
+	m_ObjectSavedHandle = FCoreUObjectDelegates::OnObjectSaved.AddRaw(this, &SuggestionDatabaseReingester::OnObjectSaved);
+	//Retried every tick until the editor exists, the ticker stops once the subscription was made.
+	if (TrySubscribeToBlueprintCompiled(0.0f))
+	{
+		m_SubscribeTickerHandle = FTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateRaw(this, &SuggestionDatabaseReingester::TrySubscribeToBlueprintCompiled));
+	}
+}
+
+SuggestionDatabaseReingester::~SuggestionDatabaseReingester()
+{
+	FCoreUObjectDelegates::OnObjectModified.Remove(m_ObjectModifiedHandle);
+	FCoreUObjectDelegates::OnObjectSaved.Remove(m_ObjectSavedHandle);
+	if (m_SubscribeTickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(m_SubscribeTickerHandle);
+	}
+	if (m_BlueprintCompiledHandle.IsValid() && GEditor != nullptr)
+	{
+		GEditor->OnBlueprintCompiled().Remove(m_BlueprintCompiledHandle);
+	}
+}
+
+void SuggestionDatabaseReingester::ReingestDirtyBlueprints()
+{
+	TSet<TWeakObjectPtr<UBlueprint>> dirtyBlueprints;
+	Exchange(dirtyBlueprints, m_DirtyBlueprints);
+	for (const TWeakObjectPtr<UBlueprint>& dirtyBlueprint : dirtyBlueprints)
+	{
+		//Blueprints that were garbage collected in the meantime are skipped.
+		UBlueprint* blueprint = dirtyBlueprint.Get();
+		if (blueprint != nullptr)
+		{
+			ReingestBlueprint(*blueprint);
+		}
+	}
+}
+
+void SuggestionDatabaseReingester::OnObjectModified(UObject* a_Object)
+{
+	//Editing a graph modifies its nodes and pins, which are all owned by the blueprint.
+	UBlueprint* blueprint = Cast<UBlueprint>(a_Object);
+	if (blueprint == nullptr && a_Object != nullptr)
+	{
+		blueprint = a_Object->GetTypedOuter<UBlueprint>();
+	}
+	if (blueprint != nullptr)
+	{
+		m_DirtyBlueprints.Add(blueprint);
+	}
+}
+
+void SuggestionDatabaseReingester::OnObjectSaved(UObject* a_Object)
+{
+	UBlueprint* blueprint = Cast<UBlueprint>(a_Object);
+	if (blueprint != nullptr && m_DirtyBlueprints.Remove(blueprint) > 0)
+	{
+		ReingestBlueprint(*blueprint);
+	}
+}
+
+void SuggestionDatabaseReingester::OnBlueprintCompiled()
+{
+	//The editor does not say which blueprint was compiled, so every modified blueprint is picked up.
+	ReingestDirtyBlueprints();
+}
+
+bool SuggestionDatabaseReingester::TrySubscribeToBlueprintCompiled(float a_DeltaTime)
+{
+	if (GEditor == nullptr)
+	{
+		return true;
+	}
+
+	m_BlueprintCompiledHandle = GEditor->OnBlueprintCompiled().AddRaw(this, &SuggestionDatabaseReingester::OnBlueprintCompiled);
+	m_SubscribeTickerHandle.Reset();
+	return false;
+}
+
+void SuggestionDatabaseReingester::ReingestBlueprint(UBlueprint& a_Blueprint)
+{
+	const uint32 startCycles = FPlatformTime::Cycles();
+	m_CancelQueriesDelegate.ExecuteIfBound();
+	//Compiling reconstructs nodes, which does not reliably modify them.
+	NodeSignatureCache::Get().InvalidateBlueprint(a_Blueprint);
+	m_Database.ReingestBlueprint(a_Blueprint);
+	UE_LOG(BILog, Log, TEXT("Re-ingested blueprint '%s' into the suggestion database in %.2f ms"), *a_Blueprint.GetName(),
+		FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startCycles));
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+class SuggestionDatabaseBase;
+/** Tracks which blueprints were modified since they were last parsed, and re-ingests them into the suggestion database
+ * when they are saved or compiled. Keeps the database current without rebuilding it from every loaded blueprint. */
+class SuggestionDatabaseReingester
+{
+public:
+	/** a_CancelQueriesDelegate is executed before the suggestion database is modified */
+	SuggestionDatabaseReingester(SuggestionDatabaseBase& a_Database, const FSimpleDelegate& a_CancelQueriesDelegate);
+	~SuggestionDatabaseReingester();
+
+	/** Re-ingests all blueprints that were modified since they were last parsed */
+	void ReingestDirtyBlueprints();
+
+private:
+	void OnObjectModified(UObject* a_Object);
+	void OnObjectSaved(UObject* a_Object);
+	void OnBlueprintCompiled();
+	/** The module starts before the editor exists, so compiles are subscribed to once it does */
+	bool TrySubscribeToBlueprintCompiled(float a_DeltaTime);
+	void ReingestBlueprint(UBlueprint& a_Blueprint);
+
+	SuggestionDatabaseBase& m_Database;
+	FSimpleDelegate m_CancelQueriesDelegate;
+
+	TSet<TWeakObjectPtr<UBlueprint>> m_DirtyBlueprints;
+	FDelegateHandle m_ObjectModifiedHandle;
+	FDelegateHandle m_ObjectSavedHandle;
+	FDelegateHandle m_BlueprintCompiledHandle;
+	FDelegateHandle m_SubscribeTickerHandle;
+};
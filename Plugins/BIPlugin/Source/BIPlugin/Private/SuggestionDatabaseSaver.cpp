@@ -0,0 +1,159 @@
+#include "BIPluginPrivatePCH.h"
+#include "SuggestionDatabaseSaver.h"
+
+#include "SuggestionDatabaseSnapshot.h"
+
+namespace
+{
+	const float MIN_FAILED_SAVE_RETRY_SECONDS = 30.0f;
+
+	TAutoConsoleVariable<float> CVarSnapshotIntervalSeconds(
+		TEXT("BIPlugin.SnapshotIntervalSeconds"),
+		120.0f,
+		TEXT("Interval in seconds between background snapshots of the suggestion database, if it changed. 0 disables snapshots"),
+		ECVF_Default);
+}
+
+/** Writes a suggestion database snapshot to disk on the thread pool */
+class SuggestionSnapshotWriteTask : public FNonAbandonableTask
+{
+public:
+	SuggestionSnapshotWriteTask(const SuggestionDatabaseBase::SuggestionDatabaseSnapshotRef& a_Snapshot, const FString& a_FilePath)
+		: m_Snapshot(a_Snapshot)
+		, m_FilePath(a_FilePath)
+		, m_Succeeded(false)
+	{
+	}
+
+	void DoWork()
+	{
+		m_Succeeded = SuggestionDatabaseSaver::WriteSnapshotToFile(*m_Snapshot, m_FilePath);
+	}
+
+	bool Succeeded() const
+	{
+		return m_Succeeded;
+	}
+
+	uint64 GetJournalSequence() const
+	{
+		return m_Snapshot->GetJournalSequence();
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(SuggestionSnapshotWriteTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+
+private:
+	SuggestionDatabaseBase::SuggestionDatabaseSnapshotRef m_Snapshot;
+	FString m_FilePath;
+	bool m_Succeeded;
+};
+
+SuggestionDatabaseSaver::SuggestionDatabaseSaver(SuggestionDatabaseBase& a_Database, const FString& a_FilePath)
+	: m_Database(a_Database)
+	, m_FilePath(a_FilePath)
+	, m_PendingSaveTask(nullptr)
+	, m_LastSaveTime(FPlatformTime::Seconds())
+	, m_LastSaveFailed(false)
+{
+	m_TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &SuggestionDatabaseSaver::OnTick), 1.0f);
+}
+
+SuggestionDatabaseSaver::~SuggestionDatabaseSaver()
+{
+	FTicker::GetCoreTicker().RemoveTicker(m_TickerHandle);
+	WaitForPendingSave();
+}
+
+void SuggestionDatabaseSaver::WaitForPendingSave()
+{
+	if (m_PendingSaveTask != nullptr)
+	{
+		m_PendingSaveTask->EnsureCompletion();
+		FinishPendingSave();
+	}
+}
+
+bool SuggestionDatabaseSaver::WriteSnapshotToFile(SuggestionDatabaseSnapshot& a_Snapshot, const FString& a_FilePath)
+{
+	const FString temporaryFilePath = a_FilePath + TEXT(".tmp");
+	FArchive* fileArchive = IFileManager::Get().CreateFileWriter(*temporaryFilePath);
+	if (fileArchive == nullptr)
+	{
+		UE_LOG(BILog, Warning, TEXT("Could not open '%s' to save the BI Plugin database"), *temporaryFilePath);
+		return false;
+	}
+
+	a_Snapshot.Serialize(*fileArchive);
+	const bool wroteFile = fileArchive->Close();
+	delete fileArchive;
+
+	//The previous database stays intact until the new one is completely on disk.
+	if (!wroteFile || !IFileManager::Get().Move(*a_FilePath, *temporaryFilePath, true, true))
+	{
+		UE_LOG(BILog, Warning, TEXT("Could not save the BI Plugin database to '%s'"), *a_FilePath);
+		IFileManager::Get().Delete(*temporaryFilePath);
+		return false;
+	}
+	return true;
+}
+
+bool SuggestionDatabaseSaver::OnTick(float a_DeltaTime)
+{
+	if (m_PendingSaveTask != nullptr && m_PendingSaveTask->IsDone())
+	{
+		FinishPendingSave();
+	}
+	if (m_PendingSaveTask != nullptr)
+	{
+		return true;
+	}
+
+	//Every snapshot pauses the game thread, so one that could not be written is not retried right away.
+	const float snapshotInterval = CVarSnapshotIntervalSeconds.GetValueOnGameThread();
+	const double secondsSinceSave = FPlatformTime::Seconds() - m_LastSaveTime;
+	if (m_LastSaveFailed && secondsSinceSave < FMath::Max(snapshotInterval, MIN_FAILED_SAVE_RETRY_SECONDS))
+	{
+		return true;
+	}
+
+	//A journal past its size limit is compacted by saving a snapshot early.
+	if (m_Database.NeedsJournalCompaction() || (snapshotInterval > 0.0f && m_Database.HasUnsavedChanges() &&
+		secondsSinceSave >= snapshotInterval))
+	{
+		StartBackgroundSave();
+	}
+	return true;
+}
+
+void SuggestionDatabaseSaver::FinishPendingSave()
+{
+	//Journaled changes can only be dropped once the snapshot containing them is on disk.
+	const SuggestionSnapshotWriteTask& task = m_PendingSaveTask->GetTask();
+	m_LastSaveFailed = !task.Succeeded();
+	if (task.Succeeded())
+	{
+		m_Database.CompactJournal(task.GetJournalSequence());
+	}
+	else
+	{
+		m_Database.MarkUnsaved();
+	}
+	delete m_PendingSaveTask;
+	m_PendingSaveTask = nullptr;
+}
+
+void SuggestionDatabaseSaver::StartBackgroundSave()
+{
+	//Copying the database is the only part the game thread pays for, serializing happens on the worker.
+	//Taking the copy only reads the database, so a query running on a worker does not have to be cancelled for it.
+	const uint32 startCycles = FPlatformTime::Cycles();
+	SuggestionDatabaseBase::SuggestionDatabaseSnapshotRef snapshot = m_Database.CreateSnapshot();
+	UE_LOG(BILog, BI_VERBOSE, TEXT("Took suggestion database snapshot in %.2f ms"), FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - startCycles));
+
+	m_PendingSaveTask = new FAsyncTask<SuggestionSnapshotWriteTask>(snapshot, m_FilePath);
+	m_PendingSaveTask->StartBackgroundTask();
+	m_LastSaveTime = FPlatformTime::Seconds();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "SuggestionDatabaseBase.h"
+
+class SuggestionSnapshotWriteTask;
+/** Periodically writes snapshots of the suggestion database in the background. Files are written to a temporary file first 
+ * and moved over the database file once complete, so a crash never leaves a truncated database behind. */
+class SuggestionDatabaseSaver
+{
+public:
+	SuggestionDatabaseSaver(SuggestionDatabaseBase& a_Database, const FString& a_FilePath);
+	~SuggestionDatabaseSaver();
+
+	void WaitForPendingSave();
+
+	/** Writes a_Snapshot to a temporary file next to a_FilePath and moves it in place. Safe to call from any thread */
+	static bool WriteSnapshotToFile(SuggestionDatabaseSnapshot& a_Snapshot, const FString& a_FilePath);
+
+private:
+	bool OnTick(float a_DeltaTime);
+	void StartBackgroundSave();
+	void FinishPendingSave();
+
+	SuggestionDatabaseBase& m_Database;
+	FString m_FilePath;
+	FAsyncTask<SuggestionSnapshotWriteTask>* m_PendingSaveTask;
+	double m_LastSaveTime;
+	bool m_LastSaveFailed; //Saves are retried after the snapshot interval instead of every tick, the journal stays too large meanwhile
+	FDelegateHandle m_TickerHandle;
+};
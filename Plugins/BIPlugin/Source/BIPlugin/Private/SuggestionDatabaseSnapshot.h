@@ -0,0 +1,24 @@
+#pragma once
+
+/** Copy of a suggestion database taken on the game thread, which can be written to disk from any thread */
+class SuggestionDatabaseSnapshot
+{
+public:
+	explicit SuggestionDatabaseSnapshot(uint64 a_JournalSequence)
+		: m_JournalSequence(a_JournalSequence)
+	{
+	}
+	virtual ~SuggestionDatabaseSnapshot() {}
+
+	/** Sequence number of the last journaled change contained in this snapshot */
+	uint64 GetJournalSequence() const
+	{
+		return m_JournalSequence;
+	}
+
+	/** Writes the snapshot in the same format SuggestionDatabaseBase::Serialize would */
+	virtual void Serialize(FArchive& a_Archive) = 0;
+
+private:
+	uint64 m_JournalSequence;
+};
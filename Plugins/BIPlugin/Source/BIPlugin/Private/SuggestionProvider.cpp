@@ -6,11 +6,66 @@
 #include "BlueprintSuggestion.h"
 #include "SuggestionDatabaseBase.h"
 #include "BlueprintSuggestionContext.h"
+#include "SuggestionQuery.h"
 
 namespace
 {
+	TAutoConsoleVariable<int32> CVarAsyncSuggestions(
+		TEXT("BIPlugin.AsyncSuggestions"),
+		1,
+		TEXT("Runs suggestion queries on a worker thread instead of blocking the action menu. 0: synchronous, 1: asynchronous"),
+		ECVF_Default);
+
+	TAutoConsoleVariable<float> CVarSuggestionTimeBudgetMs(
+		TEXT("BIPlugin.SuggestionTimeBudgetMs"),
+		30.0f,
+		TEXT("Time in milliseconds the action menu waits for an asynchronous suggestion query before opening without suggestions"),
+		ECVF_Default);
+
+	void CreateSuggestionEntries(const TArray<Suggestion>& a_Suggestions, TArray<TSharedPtr<FBlueprintSuggestion>>& a_OutEntries)
+	{
+		int32 suggestionId = 1;
+		for (const Suggestion& suggested : a_Suggestions)
+		{
+			a_OutEntries.Add(TSharedPtr<FBlueprintSuggestion>(new FBlueprintSuggestion(
+				suggested.GetNodeSignature(),
+				suggested.GetNodeSignatureGuid(),
+				suggestionId,
+				suggested.GetSuggestionContextScore(),
+				suggested.GetSuggestionUsesScore())));
+			++suggestionId;
+		}
+	}
 }
 
+/** Executes a suggestion query on the thread pool. The query only holds data snapshotted on the game thread. */
+class SuggestionQueryTask : public FNonAbandonableTask
+{
+public:
+	SuggestionQueryTask(SuggestionDatabaseBase* a_Database, const SuggestionDatabaseBase::SuggestionQueryRef& a_Query, FEvent* a_DoneEvent)
+		: m_Database(a_Database)
+		, m_Query(a_Query)
+		, m_DoneEvent(a_DoneEvent)
+	{
+	}
+
+	void DoWork()
+	{
+		m_Database->ExecuteQuery(*m_Query);
+		m_DoneEvent->Trigger();
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(SuggestionQueryTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+
+private:
+	SuggestionDatabaseBase* m_Database;
+	SuggestionDatabaseBase::SuggestionQueryRef m_Query;
+	FEvent* m_DoneEvent;
+};
+
 SuggestionProvider::SuggestionProvider(SuggestionDatabaseBase& a_Database, const RebuildDatabaseDelegate& a_RebuildDatabaseDelegate)
 	: m_SuggestionDatabase(a_Database)
 	, m_RebuildDatabaseDelegate(a_RebuildDatabaseDelegate)
@@ -18,11 +73,16 @@ SuggestionProvider::SuggestionProvider(SuggestionDatabaseBase& a_Database, const
 	, m_EnabledConsoleCommand(TEXT("BIPlugin_Enabled"), TEXT("Toggles generation of the suggestions"), 
 		FConsoleCommandDelegate::CreateRaw(this, &SuggestionProvider::OnEnabledConsoleCommand))
 	, m_SuggestionsEnabled(true)
+	, m_PendingQueryTask(nullptr)
+	, m_QueryDoneEvent(FPlatformProcess::CreateSynchEvent())
 {
 }
 
 SuggestionProvider::~SuggestionProvider()
 {
+	CancelPendingQuery();
+	delete m_QueryDoneEvent;
+
 	if (m_LastGraphForSuggestions != nullptr)
 	{
 		m_LastGraphForSuggestions->RemoveOnGraphChangedHandler(m_OnGraphChangedHandle);
@@ -38,29 +98,52 @@ void SuggestionProvider::ProvideSuggestions(const FBlueprintSuggestionContext& I
 
 	if (m_SuggestionsEnabled)
 	{
-		TArray<Suggestion> suggestions;
-		suggestions.Reserve(NUM_SUGGESTIONS);
+		//A new request makes any query still running for the previous pin stale.
+		CancelPendingQuery();
+
 		if (!m_SuggestionDatabase.HasSuggestions())
 		{
 			m_RebuildDatabaseDelegate.Execute();
 		}
 
-		m_SuggestionDatabase.ProvideSuggestions(InContext, NUM_SUGGESTIONS, suggestions);
+		SuggestionDatabaseBase::SuggestionQueryRef query = m_SuggestionDatabase.CreateQuery(InContext, NUM_SUGGESTIONS);
+		if (CVarAsyncSuggestions.GetValueOnGameThread() == 0)
+		{
+			m_SuggestionDatabase.ExecuteQuery(*query);
+			CreateSuggestionEntries(query->m_Results, OutEntries);
+			return;
+		}
 
-		int32 suggestionId = 1;
-		for (Suggestion suggested : suggestions)
+		StartPendingQuery(query);
+
+		const uint32 timeBudgetMs = static_cast<uint32>(FMath::CeilToInt(FMath::Max(CVarSuggestionTimeBudgetMs.GetValueOnGameThread(), 0.0f)));
+		if (m_QueryDoneEvent->Wait(timeBudgetMs))
 		{
-			OutEntries.Add(TSharedPtr<FBlueprintSuggestion>(new FBlueprintSuggestion(
-				suggested.GetNodeSignature(),
-				suggested.GetNodeSignatureGuid(),
-				suggestionId,
-				suggested.GetSuggestionContextScore(),
-				suggested.GetSuggestionUsesScore())));
-			++suggestionId;
+			//The event is triggered at the end of DoWork, the task itself may still be returning.
+			m_PendingQueryTask->EnsureCompletion();
+			CreateSuggestionEntries(query->m_Results, OutEntries);
+			FinishPendingQuery();
+		}
+		else
+		{
+			//The action menu cannot be updated once it is open, so it opens without suggestions and the late results are discarded.
+			//The query stops at its next cancellation check and is cleaned up by the next CancelPendingQuery.
+			UE_LOG(BILog, BI_VERBOSE, TEXT("Suggestion query exceeded the time budget, discarding its results"));
+			m_PendingQuery->Cancel();
 		}
 	}
 }
 
+void SuggestionProvider::CancelPendingQuery()
+{
+	if (m_PendingQueryTask != nullptr)
+	{
+		m_PendingQuery->Cancel();
+		m_PendingQueryTask->EnsureCompletion();
+		FinishPendingQuery();
+	}
+}
+
 void SuggestionProvider::SubscribeToGraphChanged(UEdGraph* a_Graph)
 {
 	if (m_LastGraphForSuggestions != a_Graph)
@@ -87,9 +170,8 @@ void SuggestionProvider::OnGraphChanged(const FEdGraphEditAction& a_Action)
 			*a_Action.Nodes[firstIndex]->GetNodeTitle(ENodeTitleType::MenuTitle).ToString());
 	}
 
-	if (a_Action.Action == GRAPHACTION_PinConnectionCreated)
+	if (a_Action.Action == GRAPHACTION_PinConnectionCreated || a_Action.Action == GRAPHACTION_PinConnectionBroken)
 	{
-		UE_LOG(BILog, Log, TEXT("Graph Changed; Node connection created. Adding suggestion to the database"));
 		verify(a_Action.Nodes.Num() == 2); //We assume that we have two nodes in this action which the link is created from and to.
 		const UEdGraphNode* uncastedNodeA = a_Action.Nodes[firstIndex];
 		const UEdGraphNode* uncastedNodeB = a_Action.Nodes[FSetElementId::FromInteger(1)];
@@ -100,7 +182,18 @@ void SuggestionProvider::OnGraphChanged(const FEdGraphEditAction& a_Action)
 		const UK2Node* nodeA = Cast<UK2Node>(uncastedNodeA);
 		const UK2Node* nodeB = Cast<UK2Node>(uncastedNodeB);
 
-		m_SuggestionDatabase.GenerateSuggestionForCreatedLink(*nodeA, *nodeB);
+		CancelPendingQuery();
+		if (a_Action.Action == GRAPHACTION_PinConnectionCreated)
+		{
+			UE_LOG(BILog, Log, TEXT("Graph Changed; Node connection created. Adding suggestion to the database"));
+			m_SuggestionDatabase.GenerateSuggestionForCreatedLink(*nodeA, *nodeB);
+		}
+		else
+		{
+			//Broken links are broadcast before they are removed, deleting a node breaks all of its links first.
+			UE_LOG(BILog, Log, TEXT("Graph Changed; Node connection broken. Removing suggestion from the database"));
+			m_SuggestionDatabase.RemoveSuggestionForBrokenLink(*nodeA, *nodeB);
+		}
 	}
 }
 
@@ -109,3 +202,20 @@ void SuggestionProvider::OnEnabledConsoleCommand()
 	m_SuggestionsEnabled = !m_SuggestionsEnabled;
 	UE_LOG(BILog, Log, TEXT("BIPlugin Suggestion generation is now %s"), m_SuggestionsEnabled ? TEXT("ENABLED") : TEXT("DISABLED"));
 }
+
+void SuggestionProvider::StartPendingQuery(const SuggestionDatabaseBase::SuggestionQueryRef& a_Query)
+{
+	check(m_PendingQueryTask == nullptr);
+	m_PendingQuery = a_Query;
+	//A query that missed its time budget may have triggered the event after nobody waited for it anymore.
+	m_QueryDoneEvent->Reset();
+	m_PendingQueryTask = new FAsyncTask<SuggestionQueryTask>(&m_SuggestionDatabase, a_Query, m_QueryDoneEvent);
+	m_PendingQueryTask->StartBackgroundTask();
+}
+
+void SuggestionProvider::FinishPendingQuery()
+{
+	delete m_PendingQueryTask;
+	m_PendingQueryTask = nullptr;
+	m_PendingQuery.Reset();
+}
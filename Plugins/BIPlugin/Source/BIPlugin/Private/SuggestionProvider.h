@@ -1,8 +1,10 @@
 #pragma once
 
 #include "BlueprintSuggestionProviderManager.h"
+#include "SuggestionDatabaseBase.h"
 
-class SuggestionDatabaseBase;
+struct FBlueprintSuggestion;
+class SuggestionQueryTask;
 class SuggestionProvider: public IBlueprintSuggestionProvider
 {
 public:
@@ -12,11 +14,18 @@ public:
 	~SuggestionProvider();
 
 	virtual void ProvideSuggestions(const FBlueprintSuggestionContext& InContext, TArray<TSharedPtr<FBlueprintSuggestion>>& OutEntries) override;
+
+	/** Cancels the asynchronous query in flight and waits for it to stop. Has to be called before the suggestion database is modified */
+	void CancelPendingQuery();
+
 private:
 	void SubscribeToGraphChanged(UEdGraph* a_Graph);
 	void OnGraphChanged(const FEdGraphEditAction& a_Action);
 	void OnEnabledConsoleCommand();
 
+	void StartPendingQuery(const SuggestionDatabaseBase::SuggestionQueryRef& a_Query);
+	void FinishPendingQuery();
+
 	SuggestionDatabaseBase& m_SuggestionDatabase;
 	RebuildDatabaseDelegate m_RebuildDatabaseDelegate;
 
@@ -24,4 +33,8 @@ private:
 	FDelegateHandle m_OnGraphChangedHandle;
 	FAutoConsoleCommand m_EnabledConsoleCommand;
 	bool m_SuggestionsEnabled;
+
+	TSharedPtr<SuggestionQuery, ESPMode::ThreadSafe> m_PendingQuery;
+	FAsyncTask<SuggestionQueryTask>* m_PendingQueryTask;
+	FEvent* m_QueryDoneEvent; //Triggered by the query task, so the time budget can be waited for without spinning
 };
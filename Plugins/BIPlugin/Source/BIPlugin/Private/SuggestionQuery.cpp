@@ -0,0 +1,28 @@
+#include "BIPluginPrivatePCH.h"
+#include "SuggestionQuery.h"
+
+SuggestionQuery::SuggestionQuery()
+	: m_AnchorId(NodeSignatureTable::INVALID_SIGNATURE_ID)
+	, m_Direction(EPathDirection::Forward)
+	, m_SuggestionCount(0)
+	, m_HasConnectingPin(false)
+	, m_ConnectingPinType(0)
+	, m_ConnectingPinDirection(EEdGraphPinDirection::EGPD_Input)
+	, m_SourcePin(nullptr)
+	, m_ContextGraph(nullptr)
+{
+}
+
+SuggestionQuery::~SuggestionQuery()
+{
+}
+
+void SuggestionQuery::Cancel()
+{
+	m_CancelCounter.Increment();
+}
+
+bool SuggestionQuery::IsCancelled() const
+{
+	return m_CancelCounter.GetValue() != 0;
+}
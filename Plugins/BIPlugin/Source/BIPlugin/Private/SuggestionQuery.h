@@ -0,0 +1,39 @@
+#pragma once
+
+#include "EPathDirection.h"
+#include "PathContextPath.h"
+#include "Suggestion.h"
+#include "PinTypeTable.h"
+
+/** Snapshot of everything needed to score a suggestion request. Created on the game thread, can be executed on any thread. */
+class SuggestionQuery
+{
+public:
+	SuggestionQuery();
+	~SuggestionQuery();
+
+	void Cancel();
+	bool IsCancelled() const;
+
+	NodeSignatureTable::SignatureId m_AnchorId;
+	EPathDirection m_Direction;
+	TArray<PathContextPath> m_ContextPaths;
+	int32 m_SuggestionCount;
+
+	bool m_HasConnectingPin;
+	PinTypeTable::PinTypeId m_ConnectingPinType;
+	EEdGraphPinDirection m_ConnectingPinDirection;
+	/** Sorted ids of the anchor's context specific signatures, the compatibility index does not decide about these */
+	TArray<NodeSignatureTable::SignatureId> m_ContextSpecificSignatures;
+	/** Sorted ids of the context specific signatures that accept the connecting pin in the context graph */
+	TArray<NodeSignatureTable::SignatureId> m_ContextCompatibleSignatures;
+	/** Only used to identify the request, never dereferenced off the game thread */
+	const UEdGraphPin* m_SourcePin;
+	UEdGraph* m_ContextGraph;
+	FString m_ContextGraphName;
+
+	TArray<Suggestion> m_Results;
+
+private:
+	FThreadSafeCounter m_CancelCounter;
+};
\ No newline at end of file
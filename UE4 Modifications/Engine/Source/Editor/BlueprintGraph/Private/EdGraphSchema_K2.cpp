@@ -31,6 +31,7 @@
 #include "K2Node_Tunnel.h"
 #include "K2Node_SetFieldsInStruct.h"
 #include "GenericCommands.h"
+#include "GraphEditAction.h"
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -1917,14 +1918,49 @@ const FPinConnectionResponse UEdGraphSchema_K2::CanCreateConnection(const UEdGra
 	}
 }
 
+/** Tells the listeners of the graph owning PinA that the connection between PinA and PinB changed */
+static void NotifyPinConnectionChanged(EEdGraphActionType Action, UEdGraphPin* PinA, UEdGraphPin* PinB)
+{
+	UEdGraphNode* NodeA = PinA->GetOwningNode();
+	UEdGraph* Graph = NodeA->GetGraph();
+	if (Graph != nullptr)
+	{
+		FEdGraphEditAction EditAction(Action, Graph, NodeA);
+		EditAction.Nodes.Add(PinB->GetOwningNode());
+		Graph->NotifyGraphChanged(EditAction);
+	}
+}
+
+/** Broadcasts GRAPHACTION_PinConnectionBroken for every link of TargetPin, while the links still exist */
+static void NotifyPinLinksBroken(UEdGraphPin& TargetPin)
+{
+	const TArray<UEdGraphPin*> LinkedPins = TargetPin.LinkedTo;
+	for (UEdGraphPin* LinkedPin : LinkedPins)
+	{
+		NotifyPinConnectionChanged(GRAPHACTION_PinConnectionBroken, &TargetPin, LinkedPin);
+	}
+}
+
 bool UEdGraphSchema_K2::TryCreateConnection(UEdGraphPin* PinA, UEdGraphPin* PinB) const
 {
 	UBlueprint* Blueprint = FBlueprintEditorUtils::FindBlueprintForNodeChecked(PinA->GetOwningNode());
 
+	// The base class replaces links with BreakAllPinLinks, which does not go through BreakPinLinks, so the replaced links are announced here
+	const ECanCreateConnectionResponse Response = CanCreateConnection(PinA, PinB).Response;
+	if (Response == CONNECT_RESPONSE_BREAK_OTHERS_A || Response == CONNECT_RESPONSE_BREAK_OTHERS_AB)
+	{
+		NotifyPinLinksBroken(*PinA);
+	}
+	if (Response == CONNECT_RESPONSE_BREAK_OTHERS_B || Response == CONNECT_RESPONSE_BREAK_OTHERS_AB)
+	{
+		NotifyPinLinksBroken(*PinB);
+	}
+
 	bool bModified = UEdGraphSchema::TryCreateConnection(PinA, PinB);
 
 	if (bModified)
 	{
+		NotifyPinConnectionChanged(GRAPHACTION_PinConnectionCreated, PinA, PinB);
 		FBlueprintEditorUtils::MarkBlueprintAsModified(Blueprint);
 	}
 
@@ -3511,6 +3547,7 @@ void UEdGraphSchema_K2::BreakNodeLinks(UEdGraphNode& TargetNode) const
 {
 	UBlueprint* Blueprint = FBlueprintEditorUtils::FindBlueprintForNodeChecked(&TargetNode);
 
+	// The links of every pin are broken through BreakPinLinks, which notifies about them
 	Super::BreakNodeLinks(TargetNode);
 	
 	FBlueprintEditorUtils::MarkBlueprintAsModified(Blueprint);
@@ -3523,7 +3560,7 @@ void UEdGraphSchema_K2::BreakPinLinks(UEdGraphPin& TargetPin, bool bSendsNodeNot
 	// cache this here, as BreakPinLinks can trigger a node reconstruction invalidating the TargetPin referenceS
 	UBlueprint* const Blueprint = FBlueprintEditorUtils::FindBlueprintForNodeChecked(TargetPin.GetOwningNode());
 
-
+	NotifyPinLinksBroken(TargetPin);
 
 	Super::BreakPinLinks(TargetPin, bSendsNodeNotifcation);
 
@@ -3536,6 +3573,8 @@ void UEdGraphSchema_K2::BreakSinglePinLink(UEdGraphPin* SourcePin, UEdGraphPin*
 
 	UBlueprint* Blueprint = FBlueprintEditorUtils::FindBlueprintForNodeChecked(TargetPin->GetOwningNode());
 
+	NotifyPinConnectionChanged(GRAPHACTION_PinConnectionBroken, SourcePin, TargetPin);
+
 	Super::BreakSinglePinLink(SourcePin, TargetPin);
 
 	FBlueprintEditorUtils::MarkBlueprintAsModified(Blueprint);
@@ -147,6 +147,9 @@ public:
 	/** Signal to listeners that the graph has changed */
 	void NotifyGraphChanged();
 
+	/** Signal to listeners that a specific action occurred on the graph */
+	void NotifyGraphChanged( const FEdGraphEditAction& Action );
+
 	/** 
 	 * Move all nodes from this graph to another graph
 	 * @param DestinationGraph	The graph to move the nodes too 
@@ -201,8 +204,6 @@ public:
 #endif
 
 protected:
-	void NotifyGraphChanged( const FEdGraphEditAction& Action );
-
 	/** 
 	 * Creates an empty node in this graph. Use FGraphNodeCreator above
 	 *
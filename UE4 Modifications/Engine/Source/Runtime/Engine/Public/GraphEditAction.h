@@ -16,6 +16,11 @@ enum EEdGraphActionType
 	GRAPHACTION_AddNodeUI = GRAPHACTION_AddNode | GRAPHACTION_UserInitiated,
 
 	GRAPHACTION_SelectNode = 0x1 << 2,
+
+	/** A connection between two pins was created */
+	GRAPHACTION_PinConnectionCreated = 0x1 << 4,
+	/** A connection between two pins is about to be broken, the pins are still linked */
+	GRAPHACTION_PinConnectionBroken = 0x1 << 5,
 };
 
 